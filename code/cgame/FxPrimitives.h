@@ -187,6 +187,8 @@ public:
 		else { VectorClear(mOrigin1); }
 	}
 
+	const float* GetOrigin1() const { return mOrigin1; }
+
 	void SetTimeStart(const int time)
 	{
 		mTimeStart = time;
@@ -192,6 +192,7 @@ void CMediaHandles::operator=(const CMediaHandles& that)
 
 //------------------------------------------------------
 CFxScheduler::CFxScheduler()
+	: mBoltLookupTime(-1)
 {
 	memset(&mEffectTemplates, 0, sizeof mEffectTemplates);
 	memset(&mLoopedEffectArray, 0, sizeof mLoopedEffectArray);
@@ -344,18 +345,15 @@ void SEffectTemplate::operator=(const SEffectTemplate& that)
 void CFxScheduler::Clean(const bool b_remove_templates /*= true*/, const int id_to_preserve /*= 0*/)
 {
 	// Ditch any scheduled effects
-	auto itr = mFxSchedule.begin();
-
-	while (itr != mFxSchedule.end())
+	for (TScheduledEffect& schedule : mFxSchedule)
 	{
-		auto next = itr;
-		++next;
-
-		mScheduledEffectsPool.Free(*itr);
-		mFxSchedule.erase(itr);
-
-		itr = next;
+		for (SScheduledEffect* effect : schedule)
+		{
+			mScheduledEffectsPool.Free(effect);
+		}
+		schedule.clear();
 	}
+	mBoltLookups.clear();
 
 	if (b_remove_templates)
 	{
@@ -907,7 +905,7 @@ void CFxScheduler::PlayEffect(const char* file, const int client_id, const bool
 					sfx->mPortalEffect = false;
 				}
 
-				mFxSchedule.push_front(sfx);
+				ScheduleEffect(sfx);
 			}
 		}
 	}
@@ -1252,7 +1250,7 @@ void CFxScheduler::PlayEffect(const int id, vec3_t origin, vec3_t axis[3], const
 					sfx->mStartTime++;
 				}
 
-				mFxSchedule.push_front(sfx);
+				ScheduleEffect(sfx);
 			}
 		}
 	}
@@ -1335,100 +1333,169 @@ void CFxScheduler::PlayEffect(const char* file, vec3_t origin, vec3_t forward, c
 // Return:
 //	none
 //------------------------------------------------------
-void CFxScheduler::AddScheduledEffects(const bool portal)
+// ScheduleEffect
+//	Queues up an effect to be created at its mStartTime
+//
+// Input:
+//	the filled in effect, from mScheduledEffectsPool
+//
+// Return:
+//	none
+//------------------------------------------------------
+void CFxScheduler::ScheduleEffect(SScheduledEffect* sfx)
 {
-	int oldEntNum = -1, old_bolt_index = -1, old_model_num = -1;
-	qboolean does_bolt_exist = qfalse;
+	TScheduledEffect& schedule = mFxSchedule[sfx->mPortalEffect];
 
-	if (portal)
+	schedule.push_back(sfx);
+	std::push_heap(schedule.begin(), schedule.end(), StartsLater);
+}
+
+//------------------------------------------------------
+// GetBoltOriginAxis
+//	Finds where a ghoul2 bolt on an entity is. Many
+//	scheduled effects can hang off the same bolt, so
+//	each one is only looked up once a frame.
+//
+// Input:
+//	entity, ghoul2 model and bolt
+//
+// Return:
+//	whether the bolt is there, and if so its origin and axis
+//------------------------------------------------------
+bool CFxScheduler::GetBoltOriginAxis(const int ent_num, const int model_num, const int bolt_num, vec3_t origin, vec3_t axis[3])
+{
+	if (mBoltLookupTime != theFxHelper.mTime)
 	{
-		gEffectsInPortal = true;
+		mBoltLookups.clear();
+		mBoltLookupTime = theFxHelper.mTime;
 	}
-	else
+
+	SBoltLookup* found = nullptr;
+	for (SBoltLookup& lookup : mBoltLookups)
 	{
-		AddLoopedEffects();
+		if (lookup.mEntNum == ent_num && lookup.mModelNum == model_num && lookup.mBoltNum == bolt_num)
+		{
+			found = &lookup;
+			break;
+		}
 	}
 
-	for (auto itr = mFxSchedule.begin(); itr != mFxSchedule.end(); /* do nothing */)
+	if (found == nullptr)
 	{
-		SScheduledEffect* effect = *itr;
+		SBoltLookup lookup{};
+		lookup.mEntNum = ent_num;
+		lookup.mModelNum = model_num;
+		lookup.mBoltNum = bolt_num;
 
-		if (portal == effect->mPortalEffect && effect->mStartTime <= theFxHelper.mTime)
+		const centity_t& cent = cg_entities[ent_num];
+		if (cent.gent->ghoul2.IsValid())
 		{
-			if (effect->mClientID >= 0)
+			if (model_num >= 0 && model_num < cent.gent->ghoul2.size())
 			{
-				CreateEffect(effect->mpTemplate, effect->mClientID);
+				if (cent.gent->ghoul2[model_num].mModelindex >= 0)
+				{
+					lookup.mExists = theFxHelper.GetOriginAxisFromBolt(
+						cent, model_num, bolt_num, lookup.mOrigin, lookup.mAxis) != 0;
+				}
 			}
-			else if (effect->mBoltNum == -1)
+		}
+
+		mBoltLookups.push_back(lookup);
+		found = &mBoltLookups.back();
+	}
+
+	if (!found->mExists)
+	{
+		return false;
+	}
+
+	VectorCopy(found->mOrigin, origin);
+	AxisCopy(found->mAxis, axis);
+	return true;
+}
+
+//------------------------------------------------------
+// CreateScheduledEffects
+//	Creates every scheduled effect of the given kind
+//	whose time has come
+//
+// Input:
+//	whether to do the portal effects or the normal ones
+//
+// Return:
+//	none
+//------------------------------------------------------
+void CFxScheduler::CreateScheduledEffects(const bool portal)
+{
+	TScheduledEffect& schedule = mFxSchedule[portal];
+
+	while (!schedule.empty() && schedule.front()->mStartTime <= theFxHelper.mTime)
+	{
+		std::pop_heap(schedule.begin(), schedule.end(), StartsLater);
+		SScheduledEffect* effect = schedule.back();
+		schedule.pop_back();
+
+		if (effect->mClientID >= 0)
+		{
+			CreateEffect(effect->mpTemplate, effect->mClientID);
+		}
+		else if (effect->mBoltNum == -1)
+		{
+			// normal effect
+			if (effect->mEntNum != -1) // -1
+			{
+				// Find out where the entity currently is
+				CreateEffect(effect->mpTemplate,
+					cg_entities[effect->mEntNum].lerpOrigin, effect->mAxis,
+					theFxHelper.mTime - effect->mStartTime);
+			}
+			else
+			{
+				CreateEffect(effect->mpTemplate,
+					effect->mOrigin, effect->mAxis,
+					theFxHelper.mTime - effect->mStartTime);
+			}
+		}
+		else
+		{
+			vec3_t axis[3];
+			vec3_t origin;
+
+			//bolted on effect, only do this if we found the bolt
+			if (GetBoltOriginAxis(effect->mEntNum, effect->mModelNum, effect->mBoltNum, origin, axis))
 			{
-				// normal effect
-				if (effect->mEntNum != -1) // -1
+				if (effect->mIsRelative)
 				{
-					// Find out where the entity currently is
 					CreateEffect(effect->mpTemplate,
-						cg_entities[effect->mEntNum].lerpOrigin, effect->mAxis,
-						theFxHelper.mTime - (*itr)->mStartTime);
+						vec3_origin, axis,
+						0, effect->mEntNum, effect->mModelNum, effect->mBoltNum);
 				}
 				else
 				{
 					CreateEffect(effect->mpTemplate,
-						effect->mOrigin, effect->mAxis,
+						origin, axis,
 						theFxHelper.mTime - effect->mStartTime);
 				}
 			}
-			else
-			{
-				vec3_t axis[3];
-				vec3_t origin;
-				//bolted on effect
-				// do we need to go and re-get the bolt matrix again? Since it takes time lets try to do it only once
-				if (effect->mModelNum != old_model_num || effect->mEntNum != oldEntNum || effect->mBoltNum !=
-					old_bolt_index)
-				{
-					const centity_t& cent = cg_entities[effect->mEntNum];
-					if (cent.gent->ghoul2.IsValid())
-					{
-						if (effect->mModelNum >= 0 && effect->mModelNum < cent.gent->ghoul2.size())
-						{
-							if (cent.gent->ghoul2[effect->mModelNum].mModelindex >= 0)
-							{
-								does_bolt_exist = static_cast<qboolean>(theFxHelper.GetOriginAxisFromBolt(
-									cent, effect->mModelNum, effect->mBoltNum, origin, axis) != 0);
-							}
-						}
-					}
-
-					old_model_num = effect->mModelNum;
-					oldEntNum = effect->mEntNum;
-					old_bolt_index = effect->mBoltNum;
-				}
+		}
 
-				// only do this if we found the bolt
-				if (does_bolt_exist)
-				{
-					if (effect->mIsRelative)
-					{
-						CreateEffect(effect->mpTemplate,
-							vec3_origin, axis,
-							0, effect->mEntNum, effect->mModelNum, effect->mBoltNum);
-					}
-					else
-					{
-						CreateEffect(effect->mpTemplate,
-							origin, axis,
-							theFxHelper.mTime - effect->mStartTime);
-					}
-				}
-			}
+		mScheduledEffectsPool.Free(effect);
+	}
+}
 
-			mScheduledEffectsPool.Free(effect);
-			itr = mFxSchedule.erase(itr);
-		}
-		else
-		{
-			++itr;
-		}
+//------------------------------------------------------
+void CFxScheduler::AddScheduledEffects(const bool portal)
+{
+	if (portal)
+	{
+		gEffectsInPortal = true;
 	}
+	else
+	{
+		AddLoopedEffects();
+	}
+
+	CreateScheduledEffects(portal);
 
 	// Add all active effects into the scene
 	FX_Add(portal);
@@ -1930,4 +1997,4 @@ void CFxScheduler::CreateEffect(CPrimitiveTemplate* fx, const vec3_t origin, vec
 			delete fx;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -32,6 +32,7 @@ using fxString_t = sstring_t;
 #include "qcommon/safe/string.h"
 
 #include <algorithm>
+#include <vector>
 
 #ifndef FX_SCHEDULER_H_INC
 #define FX_SCHEDULER_H_INC
@@ -437,85 +438,99 @@ class PoolAllocator
 {
 public:
 	PoolAllocator()
-		: pool(new T[N])
-		, freeAndAllocated(new int[N])
+		: pool(new Slot[N])
+		, allocated(new bool[N]())
+		, freeList(pool)
 		, numFree(N)
 		, highWatermark(0)
 	{
-		for (int i = 0; i < N; i++)
+		for (int i = 0; i < N - 1; i++)
 		{
-			freeAndAllocated[i] = i;
+			pool[i].next = &pool[i + 1];
 		}
+		pool[N - 1].next = nullptr;
 	}
 
 	T* Alloc()
 	{
-		if (numFree == 0)
+		if (freeList == nullptr)
 		{
 			return nullptr;
 		}
 
-		T* ptr = new(&pool[freeAndAllocated[0]]) T;
-
-		std::rotate(freeAndAllocated, freeAndAllocated + 1, freeAndAllocated + N);
+		Slot* slot = freeList;
+		freeList = slot->next;
+		allocated[slot - pool] = true;
 		numFree--;
 
 		highWatermark = Q_max(highWatermark, N - numFree);
 
-		return ptr;
+		return new(slot->storage) T;
 	}
 
+	// Hands the slots over to allocator, dropping the empty ones it was constructed with. This
+	// one owns nothing afterwards.
 	void TransferTo(PoolAllocator<T, N>& allocator)
 	{
-		allocator.freeAndAllocated = freeAndAllocated;
+		assert(&allocator != this);
+
+		delete[] allocator.allocated;
+		delete[] allocator.pool;
+
+		allocator.pool = pool;
+		allocator.allocated = allocated;
+		allocator.freeList = freeList;
 		allocator.highWatermark = highWatermark;
 		allocator.numFree = numFree;
-		allocator.pool = pool;
 
 		highWatermark = 0;
-		numFree = N;
-		freeAndAllocated = nullptr;
+		numFree = 0;
+		freeList = nullptr;
+		allocated = nullptr;
 		pool = nullptr;
 	}
 
 	bool OwnsPtr(const T* ptr) const
 	{
-		return ptr >= pool && ptr < pool + N;
+		const Slot* slot = reinterpret_cast<const Slot*>(ptr);
+		return slot >= pool && slot < pool + N;
 	}
 
 	void Free(T* ptr)
 	{
-		for (int i = numFree; i < N; i++)
-		{
-			T* p = &pool[freeAndAllocated[i]];
+		assert(OwnsPtr(ptr));
 
-			if (p == ptr)
-			{
-				if (i > numFree)
-				{
-					std::rotate(freeAndAllocated + numFree, freeAndAllocated + i, freeAndAllocated + i + 1);
-				}
+		Slot* slot = reinterpret_cast<Slot*>(ptr);
+		const int i = slot - pool;
+		if (!allocated[i])
+		{
+			return;
+		}
 
-				p->~T();
-				numFree++;
+		ptr->~T();
+		allocated[i] = false;
 
-				break;
-			}
-		}
+		slot->next = freeList;
+		freeList = slot;
+		numFree++;
 	}
 
 	int GetHighWatermark() const { return highWatermark; }
 
 	~PoolAllocator()
 	{
-		for (int i = numFree; i < N; i++)
+		if (allocated != nullptr)
 		{
-			T* p = &pool[freeAndAllocated[i]];
-
-			p->~T();
+			for (int i = 0; i < N; i++)
+			{
+				if (allocated[i])
+				{
+					reinterpret_cast<T*>(pool[i].storage)->~T();
+				}
+			}
 		}
 
-		delete[] freeAndAllocated;
+		delete[] allocated;
 		delete[] pool;
 	}
 
@@ -523,11 +538,16 @@ private:
 	PoolAllocator(const PoolAllocator<T, N>&);
 	PoolAllocator& operator =(const PoolAllocator<T, N>&);
 
-	T* pool;
+	// A free slot holds the link to the next free slot where the object would be.
+	union Slot
+	{
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
 
-	// The first 'numFree' elements are the indexes of the free slots.
-	// The remaining elements are the indexes of the allocated slots.
-	int* freeAndAllocated;
+	Slot* pool;
+	bool* allocated;
+	Slot* freeList;
 	int numFree;
 
 	int highWatermark;
@@ -685,14 +705,35 @@ private:
 	// this makes looking up the index based on the string name much easier
 	using TEffectID = std::map<fxString_t, int>;
 
-	using TScheduledEffect = std::list<SScheduledEffect*>;
+	// a min-heap on mStartTime, so a frame only looks at the effects that are due
+	using TScheduledEffect = std::vector<SScheduledEffect*>;
+
+	static bool StartsLater(const SScheduledEffect* a, const SScheduledEffect* b)
+	{
+		return a->mStartTime > b->mStartTime;
+	}
+
+	// where a bolt was this frame
+	struct SBoltLookup
+	{
+		int mEntNum;
+		int mModelNum;
+		int mBoltNum;
+		bool mExists;
+		vec3_t mOrigin;
+		vec3_t mAxis[3];
+	};
 
 	// Effects
 	SEffectTemplate mEffectTemplates[FX_MAX_EFFECTS];
 	TEffectID mEffectIDs; // if you only have the unique effect name, you'll have to use this to get the ID.
 
-	// List of scheduled effects that will need to be created at the correct time.
-	TScheduledEffect mFxSchedule;
+	// Scheduled effects that will need to be created at the correct time, the normal ones and then
+	//	the portal ones.
+	TScheduledEffect mFxSchedule[2];
+
+	std::vector<SBoltLookup> mBoltLookups;
+	int mBoltLookupTime;
 
 	PagedPoolAllocator<SScheduledEffect, 1024> mScheduledEffectsPool;
 
@@ -706,6 +747,10 @@ private:
 		int model_num = -1, int bolt_num = -1);
 	void CreateEffect(CPrimitiveTemplate* fx, int client_id) const;
 
+	void ScheduleEffect(SScheduledEffect* sfx);
+	void CreateScheduledEffects(bool portal);
+	bool GetBoltOriginAxis(int ent_num, int model_num, int bolt_num, vec3_t origin, vec3_t axis[3]);
+
 public:
 	CFxScheduler();
 
@@ -736,7 +781,7 @@ public:
 	void AddScheduledEffects(bool portal);
 	// call once per CGame frame [rww ammendment - twice now actually, but first only renders portal effects]
 
-	int NumScheduledFx() const { return static_cast<int>(mFxSchedule.size()); }
+	int NumScheduledFx() const { return static_cast<int>(mFxSchedule[0].size() + mFxSchedule[1].size()); }
 	void Clean(bool b_remove_templates = true, int id_to_preserve = 0); // clean out the system
 
 	// FX Override functions
@@ -26,19 +26,129 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 vec3_t WHITE = { 1.0f, 1.0f, 1.0f };
 
+extern vmCvar_t fx_pooledPrimitives;
+
+// Every primitive the FX_Add functions make comes out of a pool for its type, and FX_Add updates each
+//	type in its own loop, so it knows what it's calling. Anything made elsewhere with new (saber trails)
+//	goes in with FX_AddPrimitive and gets the virtual call and the delete.
+enum EFxPrimitiveType
+{
+	FX_PRIM_HEAP,
+	FX_PRIM_PARTICLE,
+	FX_PRIM_ORIENTED_PARTICLE,
+	FX_PRIM_LINE,
+	FX_PRIM_ELECTRICITY,
+	FX_PRIM_BEZIER,
+	FX_PRIM_TAIL,
+	FX_PRIM_CYLINDER,
+	FX_PRIM_EMITTER,
+	FX_PRIM_LIGHT,
+	FX_PRIM_FLASH,
+	FX_PRIM_POLY,
+	FX_PRIM_NUM_TYPES
+};
+
+// which of the lists above FX_NewPrimitive's T goes in
+template <typename T>
+struct SFxPrimitiveType
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_HEAP;
+};
+template <>
+struct SFxPrimitiveType<CParticle>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_PARTICLE;
+};
+template <>
+struct SFxPrimitiveType<COrientedParticle>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_ORIENTED_PARTICLE;
+};
+template <>
+struct SFxPrimitiveType<CLine>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_LINE;
+};
+template <>
+struct SFxPrimitiveType<CElectricity>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_ELECTRICITY;
+};
+template <>
+struct SFxPrimitiveType<CBezier>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_BEZIER;
+};
+template <>
+struct SFxPrimitiveType<CTail>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_TAIL;
+};
+template <>
+struct SFxPrimitiveType<CCylinder>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_CYLINDER;
+};
+template <>
+struct SFxPrimitiveType<CEmitter>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_EMITTER;
+};
+template <>
+struct SFxPrimitiveType<CLight>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_LIGHT;
+};
+template <>
+struct SFxPrimitiveType<CFlash>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_FLASH;
+};
+template <>
+struct SFxPrimitiveType<CPoly>
+{
+	static constexpr EFxPrimitiveType value = FX_PRIM_POLY;
+};
+
+constexpr auto FX_PRIM_POOL_PAGE = 128;
+
 struct SEffectList
 {
 	CEffect* mEffect;
 	int mKillTime;
 	bool mPortal;
+	EFxPrimitiveType mType;
+	int mTypeIndex; // where we are in our type's list
+};
+
+// the effects of one type that are alive, in no particular order
+struct SEffectTypeList
+{
+	SEffectList* mEffects[MAX_EFFECTS * 2]; // room for the holes a walk can leave
+	int mNumEffects;
+	int mWalkEnd; // how many FX_AddPrimitives is going through, 0 when it isn't; freeing one of those leaves a NULL
+	bool mHoles; // and some did
 };
 
 constexpr auto PI = 3.14159f;
 
 SEffectList effectList[MAX_EFFECTS];
-SEffectList* nextValidEffect;
 SFxHelper theFxHelper;
 
+static SEffectTypeList effectTypeLists[FX_PRIM_NUM_TYPES];
+
+// the slots with no effect in them, most recently freed last
+static SEffectList* freeEffects[MAX_EFFECTS];
+static int numFreeEffects;
+
+// When every slot is taken, this many of them, starting where the last search left off,
+//	are weighed up and the one we'd miss least makes way.
+constexpr auto FX_EVICT_CANDIDATES = 32;
+static int evictCursor;
+
+// whose Update or Die is running, which mustn't make way for what it adds
+static SEffectList* busyEffect;
+
 int activeFx = 0;
 int mMax = 0;
 int mMaxTime = 0;
@@ -47,8 +157,88 @@ int mParticles;
 int mOParticles;
 int mLines;
 int mTails;
+int mEvictions; // since fx_debug last showed them
+int fxEvictions; // since FX_Init
 qboolean fxInitialized = qfalse;
 
+//-------------------------
+// FX_PrimitivePool
+//-------------------------
+template <typename T>
+static PagedPoolAllocator<T, FX_PRIM_POOL_PAGE>& FX_PrimitivePool()
+{
+	static PagedPoolAllocator<T, FX_PRIM_POOL_PAGE> pool;
+	return pool;
+}
+
+//-------------------------
+// FX_NewPrimitive
+//
+// Comes out of the type's pool unless fx_pooledPrimitives is off
+//-------------------------
+template <typename T>
+static T* FX_NewPrimitive()
+{
+	if (fx_pooledPrimitives.integer)
+	{
+		return FX_PrimitivePool<T>().Alloc();
+	}
+	return new T;
+}
+
+template <typename T>
+static void FX_FreePooledPrimitive(CEffect* fx)
+{
+	FX_PrimitivePool<T>().Free(static_cast<T*>(fx));
+}
+
+static void (* const fxPrimitiveFree[FX_PRIM_NUM_TYPES])(CEffect*) =
+{
+	nullptr,
+	FX_FreePooledPrimitive<CParticle>,
+	FX_FreePooledPrimitive<COrientedParticle>,
+	FX_FreePooledPrimitive<CLine>,
+	FX_FreePooledPrimitive<CElectricity>,
+	FX_FreePooledPrimitive<CBezier>,
+	FX_FreePooledPrimitive<CTail>,
+	FX_FreePooledPrimitive<CCylinder>,
+	FX_FreePooledPrimitive<CEmitter>,
+	FX_FreePooledPrimitive<CLight>,
+	FX_FreePooledPrimitive<CFlash>,
+	FX_FreePooledPrimitive<CPoly>,
+};
+
+//-------------------------
+// FX_DeletePrimitive
+//
+// Gives the effect back to wherever it came from and takes it out of its type's list
+//-------------------------
+static void FX_DeletePrimitive(SEffectList* obj)
+{
+	if (obj->mType == FX_PRIM_HEAP)
+	{
+		delete obj->mEffect;
+	}
+	else
+	{
+		fxPrimitiveFree[obj->mType](obj->mEffect);
+	}
+	obj->mEffect = nullptr;
+	freeEffects[numFreeEffects++] = obj;
+
+	SEffectTypeList& list = effectTypeLists[obj->mType];
+	if (obj->mTypeIndex < list.mWalkEnd)
+	{
+		// moving the last one in here could put it in front of the walk again
+		list.mEffects[obj->mTypeIndex] = nullptr;
+		list.mHoles = true;
+		return;
+	}
+	SEffectList* last = list.mEffects[--list.mNumEffects];
+	list.mEffects[obj->mTypeIndex] = last;
+	last->mTypeIndex = obj->mTypeIndex;
+}
+
 //-------------------------
 // FX_Free
 //
@@ -60,10 +250,8 @@ bool FX_Free()
 	{
 		if (i.mEffect)
 		{
-			delete i.mEffect;
+			FX_DeletePrimitive(&i);
 		}
-
-		i.mEffect = nullptr;
 	}
 
 	activeFx = 0;
@@ -83,10 +271,8 @@ void FX_Stop()
 	{
 		if (i.mEffect)
 		{
-			delete i.mEffect;
+			FX_DeletePrimitive(&i);
 		}
-
-		i.mEffect = nullptr;
 	}
 
 	activeFx = 0;
@@ -109,14 +295,28 @@ int FX_Init()
 		{
 			i.mEffect = nullptr;
 		}
+		for (auto& list : effectTypeLists)
+		{
+			list.mNumEffects = 0;
+			list.mWalkEnd = 0;
+			list.mHoles = false;
+		}
+
+		// hand out the low slots first
+		numFreeEffects = 0;
+		for (int i = MAX_EFFECTS - 1; i >= 0; i--)
+		{
+			freeEffects[numFreeEffects++] = &effectList[i];
+		}
 	}
 
 	FX_Free();
 
 	mMax = 0;
 	mMaxTime = 0;
+	mEvictions = 0;
+	fxEvictions = 0;
 
-	nextValidEffect = &effectList[0];
 	theFxHelper.Init();
 
 	// ( nothing to see here, go away )
@@ -132,53 +332,73 @@ int FX_Init()
 //-------------------------
 static void FX_FreeMember(SEffectList* obj)
 {
+	SEffectList* was_busy = busyEffect;
+	busyEffect = obj;
 	obj->mEffect->Die();
-	delete obj->mEffect;
-	obj->mEffect = nullptr;
+	busyEffect = was_busy;
 
-	// May as well mark this to be used next
-	nextValidEffect = obj;
+	FX_DeletePrimitive(obj);
 
 	activeFx--;
 }
 
+//-------------------------
+// FX_EffectWorth
+//
+// How much we'd miss an effect: the time it has left, less the further it is from the view,
+//	and less again when it's behind
+//-------------------------
+static float FX_EffectWorth(const SEffectList* ef)
+{
+	vec3_t dir;
+	VectorSubtract(ef->mEffect->GetOrigin1(), cg.refdef.vieworg, dir);
+
+	float worth = Q_max(ef->mKillTime - theFxHelper.mTime, 1) / (1.0f + VectorLengthSquared(dir) * (1.0f / (512.0f * 512.0f)));
+	if (DotProduct(dir, cg.refdef.viewaxis[0]) < 0.0f)
+	{
+		worth *= 0.25f;
+	}
+	return worth;
+}
+
 //-------------------------
 // FX_GetValidEffect
 //
 // Finds an unused effect slot
-//
-// Note - in the editor, this function may return NULL, indicating that all
-// effects are being stopped.
 //-------------------------
 static SEffectList* FX_GetValidEffect()
 {
-	if (nextValidEffect->mEffect == nullptr)
+	if (numFreeEffects == 0)
 	{
-		return nextValidEffect;
-	}
-
-	int i;
-	SEffectList* ef;
+		// out of effects, something has to make way
+		SEffectList* victim = nullptr;
+		float victim_worth = 0.0f;
+		for (int i = 0; i < FX_EVICT_CANDIDATES; i++)
+		{
+			SEffectList* ef = &effectList[evictCursor];
+			evictCursor = (evictCursor + 1) % MAX_EFFECTS;
+			if (ef == busyEffect)
+			{
+				continue;
+			}
 
-	// Blah..plow through the list till we find something that is currently untainted
-	for (i = 0, ef = effectList; i < MAX_EFFECTS; i++, ef++)
-	{
-		if (ef->mEffect == nullptr)
-		{
-			return ef;
+			const float worth = FX_EffectWorth(ef);
+			if (!victim || worth < victim_worth)
+			{
+				victim = ef;
+				victim_worth = worth;
+			}
 		}
-	}
 
-	// report the error.
-#ifndef FINAL_BUILD
-	theFxHelper.Print("FX system out of effects\n");
-#endif
+		// no death effect, that would only want another slot
+		FX_DeletePrimitive(victim);
+		activeFx--;
 
-	// Hmmm.. just trashing the first effect in the list is a poor approach
-	FX_FreeMember(&effectList[0]);
+		mEvictions++;
+		fxEvictions++;
+	}
 
-	// Recursive call
-	return nextValidEffect;
+	return freeEffects[--numFreeEffects];
 }
 
 //-------------------------
@@ -196,45 +416,102 @@ bool FX_ActiveFx()
 //
 // Adds all fx to the view
 //-------------------------
-void FX_Add(const bool portal)
+template <typename T>
+static bool FX_UpdatePrimitive(CEffect* fx)
 {
-	int i;
-	SEffectList* ef;
+	return static_cast<T*>(fx)->T::Update();
+}
 
-	drawnFx = 0;
-	mParticles = 0;
-	mOParticles = 0;
-	mLines = 0;
-	mTails = 0;
+template <>
+bool FX_UpdatePrimitive<CEffect>(CEffect* fx)
+{
+	return fx->Update();
+}
 
-	int num_fx = activeFx; //but stop when there can't be any more left!
-	for (i = 0, ef = effectList; i < MAX_EFFECTS && num_fx; i++, ef++)
+//-------------------------
+// FX_AddPrimitives
+//
+// Updates all the effects of one type. Whatever is freed along the way, by dying or by
+//	making way for something new, just leaves a hole until the walk is done, so nothing
+//	gets updated twice. Effects of this type added along the way wait a frame.
+//-------------------------
+template <typename T>
+static void FX_AddPrimitives(const EFxPrimitiveType type, const bool portal)
+{
+	SEffectTypeList& list = effectTypeLists[type];
+	list.mWalkEnd = list.mNumEffects;
+	for (int i = list.mWalkEnd - 1; i >= 0; i--)
 	{
-		if (ef->mEffect != nullptr)
+		SEffectList* ef = list.mEffects[i];
+		if (ef == nullptr)
 		{
-			--num_fx;
-			if (portal != ef->mPortal)
-			{
-				continue; //this one does not render in this scene
-			}
-			// Effect is active
-			if (theFxHelper.mTime > ef->mKillTime)
+			continue; // freed from under us
+		}
+		if (portal != ef->mPortal)
+		{
+			continue; //this one does not render in this scene
+		}
+		// Effect is active
+		if (theFxHelper.mTime > ef->mKillTime)
+		{
+			// Clean up old effects, calling any death effects as needed
+			// this flag just has to be cleared otherwise death effects might not happen correctly
+			ef->mEffect->ClearFlags(FX_KILL_ON_IMPACT);
+			FX_FreeMember(ef);
+		}
+		else
+		{
+			busyEffect = ef;
+			const bool alive = FX_UpdatePrimitive<T>(ef->mEffect);
+			busyEffect = nullptr;
+
+			if (alive == false)
 			{
-				// Clean up old effects, calling any death effects as needed
-				// this flag just has to be cleared otherwise death effects might not happen correctly
-				ef->mEffect->ClearFlags(FX_KILL_ON_IMPACT);
+				// We've been marked for death
 				FX_FreeMember(ef);
 			}
-			else
+		}
+	}
+	list.mWalkEnd = 0;
+
+	if (list.mHoles)
+	{
+		int num_effects = 0;
+		for (int i = 0; i < list.mNumEffects; i++)
+		{
+			SEffectList* ef = list.mEffects[i];
+			if (ef != nullptr)
 			{
-				if (ef->mEffect->Update() == false)
-				{
-					// We've been marked for death
-					FX_FreeMember(ef);
-				}
+				ef->mTypeIndex = num_effects;
+				list.mEffects[num_effects++] = ef;
 			}
 		}
+		list.mNumEffects = num_effects;
+		list.mHoles = false;
 	}
+}
+
+void FX_Add(const bool portal)
+{
+	drawnFx = 0;
+	mParticles = 0;
+	mOParticles = 0;
+	mLines = 0;
+	mTails = 0;
+
+	// emitters first, so what they throw out gets drawn this frame
+	FX_AddPrimitives<CEmitter>(FX_PRIM_EMITTER, portal);
+	FX_AddPrimitives<CEffect>(FX_PRIM_HEAP, portal);
+	FX_AddPrimitives<CParticle>(FX_PRIM_PARTICLE, portal);
+	FX_AddPrimitives<COrientedParticle>(FX_PRIM_ORIENTED_PARTICLE, portal);
+	FX_AddPrimitives<CLine>(FX_PRIM_LINE, portal);
+	FX_AddPrimitives<CElectricity>(FX_PRIM_ELECTRICITY, portal);
+	FX_AddPrimitives<CBezier>(FX_PRIM_BEZIER, portal);
+	FX_AddPrimitives<CTail>(FX_PRIM_TAIL, portal);
+	FX_AddPrimitives<CCylinder>(FX_PRIM_CYLINDER, portal);
+	FX_AddPrimitives<CLight>(FX_PRIM_LIGHT, portal);
+	FX_AddPrimitives<CFlash>(FX_PRIM_FLASH, portal);
+	FX_AddPrimitives<CPoly>(FX_PRIM_POLY, portal);
 	if (fx_debug.integer == 2 && !portal)
 	{
 		if (theFxHelper.mFrameTime > 100 || theFxHelper.mFrameTime < 5)
@@ -356,16 +633,27 @@ void FX_Add(const bool portal)
 		// Scheduled
 		if (theFxScheduler.NumScheduledFx() > 100)
 		{
-			theFxHelper.Print(">Scheduled ^1%4i\n", theFxScheduler.NumScheduledFx());
+			theFxHelper.Print(">Scheduled ^1%4i  ", theFxScheduler.NumScheduledFx());
 		}
 		else if (theFxScheduler.NumScheduledFx() > 50)
 		{
-			theFxHelper.Print(">Scheduled ^3%4i\n", theFxScheduler.NumScheduledFx());
+			theFxHelper.Print(">Scheduled ^3%4i  ", theFxScheduler.NumScheduledFx());
 		}
 		else
 		{
-			theFxHelper.Print(">Scheduled %4i\n", theFxScheduler.NumScheduledFx());
+			theFxHelper.Print(">Scheduled %4i  ", theFxScheduler.NumScheduledFx());
 		}
+
+		// Evicted
+		if (mEvictions > 0)
+		{
+			theFxHelper.Print(">Evicted ^1%4i ^7(%i total)\n", mEvictions, fxEvictions);
+		}
+		else
+		{
+			theFxHelper.Print(">Evicted %4i (%i total)\n", mEvictions, fxEvictions);
+		}
+		mEvictions = 0;
 	}
 }
 
@@ -376,19 +664,42 @@ void FX_Add(const bool portal)
 // all effects are being stopped.
 //-------------------------
 extern bool gEffectsInPortal; //from FXScheduler.cpp so i don't have to pass it in on EVERY FX_ADD*
-void FX_AddPrimitive(CEffect** p_effect, const int kill_time)
+static void FX_AddPrimitive(CEffect* effect, const EFxPrimitiveType type, const int kill_time)
 {
 	SEffectList* item = FX_GetValidEffect();
 
-	item->mEffect = *p_effect;
+	item->mEffect = effect;
 	item->mKillTime = theFxHelper.mTime + kill_time;
 	item->mPortal = gEffectsInPortal; //global set in AddScheduledEffects
+	item->mType = type;
+
+	SEffectTypeList& list = effectTypeLists[type];
+	assert(list.mNumEffects < static_cast<int>(ARRAY_LEN(list.mEffects)));
+	item->mTypeIndex = list.mNumEffects;
+	list.mEffects[list.mNumEffects++] = item;
 
 	activeFx++;
 
 	// Stash these in the primitive so it has easy access to the vals
-	(*p_effect)->SetTimeStart(theFxHelper.mTime);
-	(*p_effect)->SetTimeEnd(theFxHelper.mTime + kill_time);
+	effect->SetTimeStart(theFxHelper.mTime);
+	effect->SetTimeEnd(theFxHelper.mTime + kill_time);
+}
+
+void FX_AddPrimitive(CEffect** p_effect, const int kill_time)
+{
+	FX_AddPrimitive(*p_effect, FX_PRIM_HEAP, kill_time);
+}
+
+//-------------------------
+// FX_AddPooledPrimitive
+//
+// For what FX_NewPrimitive just made
+//-------------------------
+template <typename T>
+static void FX_AddPooledPrimitive(T* fx, const int kill_time)
+{
+	constexpr EFxPrimitiveType type = SFxPrimitiveType<T>::value;
+	FX_AddPrimitive(fx, fx_pooledPrimitives.integer ? type : FX_PRIM_HEAP, kill_time);
 }
 
 //-------------------------
@@ -411,7 +722,7 @@ CParticle* FX_AddParticle(const int client_id, const vec3_t org, const vec3_t ve
 		return nullptr;
 	}
 
-	auto fx = new CParticle;
+	auto fx = FX_NewPrimitive<CParticle>();
 
 	if (fx)
 	{
@@ -479,7 +790,7 @@ CParticle* FX_AddParticle(const int client_id, const vec3_t org, const vec3_t ve
 		fx->SetDeathFxID(death_id);
 		fx->SetImpactFxID(impact_id);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -502,7 +813,7 @@ CLine* FX_AddLine(const int client_id, vec3_t start, vec3_t end, const float siz
 		return nullptr;
 	}
 
-	auto fx = new CLine;
+	auto fx = FX_NewPrimitive<CLine>();
 
 	if (fx)
 	{
@@ -564,7 +875,7 @@ CLine* FX_AddLine(const int client_id, vec3_t start, vec3_t end, const float siz
 		fx->SetSTScale(1.0f, 1.0f);
 		fx->SetImpactFxID(impact_fx_id);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -587,7 +898,7 @@ CElectricity* FX_AddElectricity(const int client_id, vec3_t start, vec3_t end, c
 		return nullptr;
 	}
 
-	auto fx = new CElectricity;
+	auto fx = FX_NewPrimitive<CElectricity>();
 
 	if (fx)
 	{
@@ -650,7 +961,7 @@ CElectricity* FX_AddElectricity(const int client_id, vec3_t start, vec3_t end, c
 
 		fx->SetSTScale(1.0f, 1.0f);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL?
 		if (fx)
 		{
@@ -679,7 +990,7 @@ CTail* FX_AddTail(const int client_id, vec3_t org, vec3_t vel, vec3_t accel,
 		return nullptr;
 	}
 
-	auto fx = new CTail;
+	auto fx = FX_NewPrimitive<CTail>();
 
 	if (fx)
 	{
@@ -757,7 +1068,7 @@ CTail* FX_AddTail(const int client_id, vec3_t org, vec3_t vel, vec3_t accel,
 		fx->SetDeathFxID(death_id);
 		fx->SetImpactFxID(impact_id);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -782,7 +1093,7 @@ CCylinder* FX_AddCylinder(const int client_id, vec3_t start, vec3_t normal,
 		return nullptr;
 	}
 
-	auto fx = new CCylinder;
+	auto fx = FX_NewPrimitive<CCylinder>();
 
 	if (fx)
 	{
@@ -869,7 +1180,7 @@ CCylinder* FX_AddCylinder(const int client_id, vec3_t start, vec3_t normal,
 		fx->SetShader(shader);
 		fx->SetFlags(flags);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 	}
 
 	return fx;
@@ -894,7 +1205,7 @@ CEmitter* FX_AddEmitter(vec3_t org, vec3_t vel, vec3_t accel,
 		return nullptr;
 	}
 
-	auto fx = new CEmitter;
+	auto fx = FX_NewPrimitive<CEmitter>();
 
 	if (fx)
 	{
@@ -959,7 +1270,7 @@ CEmitter* FX_AddEmitter(vec3_t org, vec3_t vel, vec3_t accel,
 		fx->SetLastOrg(org);
 		fx->SetLastVel(vel);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -979,7 +1290,7 @@ CLight* FX_AddLight(vec3_t org, const float size1, const float size2, const floa
 		return nullptr;
 	}
 
-	auto fx = new CLight;
+	auto fx = FX_NewPrimitive<CLight>();
 
 	if (fx)
 	{
@@ -1014,7 +1325,7 @@ CLight* FX_AddLight(vec3_t org, const float size1, const float size2, const floa
 
 		fx->SetFlags(flags);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -1040,7 +1351,7 @@ COrientedParticle* FX_AddOrientedParticle(const int client_id, vec3_t org, vec3_
 		return nullptr;
 	}
 
-	auto fx = new COrientedParticle;
+	auto fx = FX_NewPrimitive<COrientedParticle>();
 
 	if (fx)
 	{
@@ -1109,7 +1420,7 @@ COrientedParticle* FX_AddOrientedParticle(const int client_id, vec3_t org, vec3_
 		fx->SetDeathFxID(death_id);
 		fx->SetImpactFxID(impact_id);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -1132,7 +1443,7 @@ CPoly* FX_AddPoly(const vec3_t* verts, const vec2_t* st, const int numVerts,
 		return nullptr;
 	}
 
-	auto fx = new CPoly;
+	auto fx = FX_NewPrimitive<CPoly>();
 
 	if (fx)
 	{
@@ -1183,7 +1494,7 @@ CPoly* FX_AddPoly(const vec3_t* verts, const vec2_t* st, const int numVerts,
 		// Now that we've set our data up, let's process it into a useful format
 		fx->PolyInit();
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 		// in the editor, fx may now be NULL
 	}
 
@@ -1207,7 +1518,7 @@ CBezier* FX_AddBezier(const vec3_t start, const vec3_t end,
 		return nullptr;
 	}
 
-	auto fx = new CBezier;
+	auto fx = FX_NewPrimitive<CBezier>();
 
 	if (fx)
 	{
@@ -1262,7 +1573,7 @@ CBezier* FX_AddBezier(const vec3_t start, const vec3_t end,
 
 		fx->SetSTScale(1.0f, 1.0f);
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 	}
 
 	return fx;
@@ -1280,7 +1591,7 @@ CFlash* FX_AddFlash(vec3_t origin, vec3_t s_rgb, vec3_t e_rgb, const float rgb_p
 		return nullptr;
 	}
 
-	auto fx = new CFlash;
+	auto fx = FX_NewPrimitive<CFlash>();
 
 	if (fx)
 	{
@@ -1333,7 +1644,7 @@ CFlash* FX_AddFlash(vec3_t origin, vec3_t s_rgb, vec3_t e_rgb, const float rgb_p
 
 		fx->Init();
 
-		FX_AddPrimitive(reinterpret_cast<CEffect**>(&fx), kill_time);
+		FX_AddPooledPrimitive(fx, kill_time);
 	}
 
 	return fx;
@@ -1421,4 +1732,4 @@ void FX_AddQuad(vec3_t origin, vec3_t normal,
 		rotation, 0.0f,
 		nullptr, nullptr, 0.0f, 0, 0, life,
 		shader, 0);
-}
\ No newline at end of file
+}
@@ -382,6 +382,7 @@ vmCvar_t cg_smoothPlayerPlat;
 vmCvar_t cg_smoothPlayerPlatAccel;
 vmCvar_t cg_g2Marks;
 vmCvar_t fx_expensivePhysics;
+vmCvar_t fx_pooledPrimitives;
 vmCvar_t cg_debugHealthBars;
 vmCvar_t cg_debugBlockBars;
 vmCvar_t cg_debugFatigueBars;
@@ -601,6 +602,7 @@ static cvarTable_t cvarTable[] = {
 	{&cg_smoothPlayerPlatAccel, "cg_smoothPlayerPlatAccel", "3.25", 0},
 	{&cg_g2Marks, "cg_g2Marks", "1", CVAR_ARCHIVE},
 	{&fx_expensivePhysics, "fx_expensivePhysics", "1", CVAR_ARCHIVE},
+	{&fx_pooledPrimitives, "fx_pooledPrimitives", "1", 0},
 	{&cg_debugHealthBars, "cg_debugHealthBars", "0", CVAR_ARCHIVE},
 	{&cg_debugBlockBars, "cg_drawblockpointbar", "0", CVAR_ARCHIVE},
 	{&cg_debugFatigueBars, "cg_drawfatiguepointbar", "0", CVAR_ARCHIVE},
@@ -1595,6 +1595,7 @@ CL_FirstSnapshot
 void CL_FirstSnapshot()
 {
 	re.RegisterMedia_LevelLoadEnd();
+	FS_LevelLoadEnd();
 
 	cls.state = CA_ACTIVE;
 
@@ -85,6 +85,7 @@ using MusicInfo_t = struct
 	byte* pLoadedData; // Z_Malloc, Z_Free	// these two MUST be kept as valid/invalid together
 	char sLoadedDataName[MAX_QPATH]; //  " " " " "
 	int iLoadedDataLen;
+	qboolean bLoadedDataMapped; // pLoadedData is an FS_MapFile() view of the pk3, not a Z_Malloc, so FS_FreeFile it
 	//
 	// remaining dynamic fields...
 	//
@@ -4197,7 +4198,15 @@ static void FreeMusic(MusicInfo_t* pMusicInfo)
 {
 	if (pMusicInfo->pLoadedData)
 	{
-		Z_Free(pMusicInfo->pLoadedData);
+		if (pMusicInfo->bLoadedDataMapped)
+		{
+			FS_FreeFile(pMusicInfo->pLoadedData);
+			pMusicInfo->bLoadedDataMapped = qfalse;
+		}
+		else
+		{
+			Z_Free(pMusicInfo->pLoadedData);
+		}
 		pMusicInfo->pLoadedData = nullptr; // these two MUST be kept as valid/invalid together
 		pMusicInfo->sLoadedDataName[0] = '\0'; //
 		pMusicInfo->iLoadedDataLen = 0;
@@ -4212,6 +4221,7 @@ void S_UnCacheDynamicMusic()
 	{
 		FreeMusic(&tMusic_Info[i]);
 	}
+	FreeMusic(&tMusic_Info[eBGRNDTRACK_NONDYNAMIC]); // can be holding a view of a pk3 from streaming
 }
 
 static qboolean S_StartBackgroundTrack_Actual(MusicInfo_t* pMusicInfo, const qboolean qbDynamic, const char* intro,
@@ -4255,7 +4265,23 @@ static qboolean S_StartBackgroundTrack_Actual(MusicInfo_t* pMusicInfo, const qbo
 		}
 		else
 		{
-			pMusicInfo->iLoadedDataLen = FS_FOpenFileRead(name, &pMusicInfo->s_backgroundFile, qtrue);
+			// if it's stored uncompressed in a pk3 then we can decode straight out of a mapping of that, which is
+			//	as good as having it in memory but without the copy, so treat it the same as loaded dynamic music...
+			//
+			void* pvMappedData;
+			const long lMappedLen = FS_MapFile(name, &pvMappedData);
+			if (pvMappedData)
+			{
+				pMusicInfo->pLoadedData = static_cast<byte*>(pvMappedData);
+				pMusicInfo->bLoadedDataMapped = qtrue;
+				pMusicInfo->iLoadedDataLen = lMappedLen;
+				Q_strncpyz(pMusicInfo->sLoadedDataName, name, sizeof(pMusicInfo->sLoadedDataName));
+				pMusicInfo->s_backgroundFile = -1;
+			}
+			else
+			{
+				pMusicInfo->iLoadedDataLen = FS_FOpenFileRead(name, &pMusicInfo->s_backgroundFile, qtrue);
+			}
 		}
 
 		if (!pMusicInfo->s_backgroundFile)
@@ -4271,7 +4297,7 @@ static qboolean S_StartBackgroundTrack_Actual(MusicInfo_t* pMusicInfo, const qbo
 		// scan up to halfway of it to find floating headers, so don't make it
 		// too small. 8k works fine.
 		qboolean bMusicSucceeded = qfalse;
-		if (qbDynamic)
+		if (qbDynamic || pMusicInfo->pLoadedData)
 		{
 			if (!pMusicInfo->pLoadedData)
 			{
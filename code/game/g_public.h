@@ -25,7 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define __G_PUBLIC_H__
 // g_public.h -- game module information visible to server
 
-#define	GAME_API_VERSION	10
+#define	GAME_API_VERSION	11
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -82,6 +82,18 @@ using SavedGameJustLoaded_e = enum
 	eAUTO,
 };
 
+// one trace for traceBatch, with the same meaning as trace's parameters
+using traceRequest_t = struct
+{
+	vec3_t start;
+	vec3_t mins, maxs; // all zero for a line trace
+	vec3_t end;
+	int passEntityNum;
+	int contentmask;
+	EG2_Collision eG2TraceType;
+	int useLod;
+};
+
 #ifndef GAME_INCLUDE
 
 // the server needs to know enough information to handle collision and snapshot generation
@@ -221,6 +233,9 @@ using game_import_t = struct
 	// collision detection against all linked entities
 	void (*trace)(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
 		int passEntityNum, int contentmask, EG2_Collision eG2TraceType, int useLod);
+	// the same, for a whole array of traces at once. Overlapping moves share the entity gather, and from 16
+	// traces up the world traces run in parallel
+	void (*traceBatch)(trace_t* results, const traceRequest_t* requests, int numRequests);
 
 	// point contents against all linked entities
 	int (*pointcontents)(const vec3_t point, int passEntityNum);
@@ -488,6 +488,7 @@ public:
 	surfaceInfo_v mSlist;
 	boltInfo_v mBltlist;
 	boneInfo_v mBlist;
+	mutable std::vector<short> mBoneSlots; // mBlist slot last seen for each skeleton bone, -1 if none, see G2_Find_Bone
 	// save from here (do not put any ptrs etc within this save block unless you adds special handlers to G2_SaveGhoul2Models / G2_LoadGhoul2Models!!!!!!!!!!!!
 #define BSAVE_START_FIELD mModelindex	// this is the start point for loadsave, keep it up to date it you change anything
 	int mModelindex;
@@ -4820,13 +4820,12 @@ constexpr auto SABER_RADIUS_DAMAGE_DIST = 2;
 constexpr auto SABER_COLLISION_DIST = 6;
 extern qboolean InFront(vec3_t spot, vec3_t from, vec3_t fromAngles, float threshHold = 0.0f);
 
-static qboolean WP_SaberDamageForTrace(const int ignore, vec3_t start, vec3_t end, float dmg, vec3_t blade_dir,
-	const qboolean no_ghoul, const saberType_t saber_type, const qboolean extrapolate,
-	const int saber_num, const int blade_num)
+// fills in the blade trace that WP_SaberDamageForTrace does, so several can go to gi.traceBatch together
+static void WP_SaberDamageTraceRequest(const int ignore, vec3_t start, vec3_t end, const qboolean no_ghoul,
+	const qboolean extrapolate, const int saber_num, const int blade_num, traceRequest_t& request)
 {
-	trace_t tr;
 	constexpr int mask = MASK_SHOT | CONTENTS_LIGHTSABER;
-	gentity_t* attacker = &g_entities[ignore];
+	const gentity_t* attacker = &g_entities[ignore];
 	vec3_t end2;
 	VectorCopy(end, end2);
 
@@ -4882,19 +4881,42 @@ static qboolean WP_SaberDamageForTrace(const int ignore, vec3_t start, vec3_t en
 			}, trace_maxs = {
 				use_radius_for_damage, use_radius_for_damage, use_radius_for_damage
 			};
-			gi.trace(&tr, start, trace_mins, trace_maxs, end2, ignore, mask, G2_COLLIDE, 10); //G2_SUPERSIZEDBBOX
+			VectorCopy(trace_mins, request.mins);
+			VectorCopy(trace_maxs, request.maxs);
 		}
 		else
 		{
 			//reborn use smaller traces
-			gi.trace(&tr, start, nullptr, nullptr, end2, ignore, mask, G2_COLLIDE, 10); //G2_SUPERSIZEDBBOX
+			VectorClear(request.mins);
+			VectorClear(request.maxs);
 		}
+		request.eG2TraceType = G2_COLLIDE; //G2_SUPERSIZEDBBOX
 	}
 	else
 	{
-		gi.trace(&tr, start, nullptr, nullptr, end2, ignore, mask, G2_NOCOLLIDE, 10);
+		VectorClear(request.mins);
+		VectorClear(request.maxs);
+		request.eG2TraceType = G2_NOCOLLIDE;
 	}
 
+	VectorCopy(start, request.start);
+	VectorCopy(end2, request.end);
+	request.passEntityNum = ignore;
+	request.contentmask = mask;
+	request.useLod = 10;
+}
+
+// everything WP_SaberDamageForTrace does with the trace once it's back
+static qboolean WP_SaberDamageForTraceResult(trace_t& tr, const traceRequest_t& request, float dmg,
+	vec3_t blade_dir, const qboolean no_ghoul, const saberType_t saber_type, const int saber_num, const int blade_num)
+{
+	constexpr int mask = MASK_SHOT | CONTENTS_LIGHTSABER;
+	const int ignore = request.passEntityNum;
+	gentity_t* attacker = &g_entities[ignore];
+	vec3_t start, end2;
+	VectorCopy(request.start, start);
+	VectorCopy(request.end, end2);
+
 #ifndef FINAL_BUILD
 	if (d_saberCombat->integer > 1)
 	{
@@ -5373,6 +5395,19 @@ static qboolean WP_SaberDamageForTrace(const int ignore, vec3_t start, vec3_t en
 	return qfalse;
 }
 
+static qboolean WP_SaberDamageForTrace(const int ignore, vec3_t start, vec3_t end, const float dmg, vec3_t blade_dir,
+	const qboolean no_ghoul, const saberType_t saber_type, const qboolean extrapolate,
+	const int saber_num, const int blade_num)
+{
+	traceRequest_t request;
+	trace_t tr;
+
+	WP_SaberDamageTraceRequest(ignore, start, end, no_ghoul, extrapolate, saber_num, blade_num, request);
+	gi.trace(&tr, request.start, request.mins, request.maxs, request.end, request.passEntityNum, request.contentmask,
+		request.eG2TraceType, request.useLod);
+	return WP_SaberDamageForTraceResult(tr, request, dmg, blade_dir, no_ghoul, saber_type, saber_num, blade_num);
+}
+
 constexpr auto LOCK_IDEAL_DIST_TOP = 32.0f;
 constexpr auto LOCK_IDEAL_DIST_CIRCLE = 48.0f;
 constexpr auto LOCK_IDEAL_DIST_JKA = 46.0f;
@@ -7193,6 +7228,10 @@ void WP_SaberDamageTrace( gentity_t *ent, int saber_num, int blade_num )
 ---------------------------------------------------------
 */
 constexpr auto MAX_SABER_SWING_INC = 0.33f;
+constexpr int MAX_SABER_BLADE_STEPS = 32; // blade points traced in one batch, any further go one at a time
+
+static traceRequest_t saberBladeRequests[MAX_SABER_BLADE_STEPS];
+static trace_t saberBladeTraces[MAX_SABER_BLADE_STEPS];
 
 static void WP_SaberDamageTrace(gentity_t* ent, int saber_num, int blade_num)
 {
@@ -7756,16 +7795,48 @@ static void WP_SaberDamageTrace(gentity_t* ent, int saber_num, int blade_num)
 				VectorMA(base_old, curDirFrac, base_diff, cur_base2);
 			}
 			// Move up the blade in intervals of stepsize
+			// Until one of them hits a saber (which bends curMD2 for the rest) the blade points don't
+			//	depend on each other, so they all go to the server in one batch (where the blade's
+			//	overlapping moves share one entity gather), and it's only one at a time from a saber hit on
+			int num_batched = 0;
+			int next_batched = 0;
+			if (saberHitFraction >= 1.0)
+			{
+				for (step = stepsize; step < ent->client->ps.saber[saber_num].blade[blade_num].length && step < ent->
+					client->ps.saber[saber_num].blade[blade_num].lengthOld && num_batched < MAX_SABER_BLADE_STEPS; step
+					+= 12)
+				{
+					vec3_t blade_point_new;
+					vec3_t blade_point_old;
+					VectorMA(cur_base1, step, cur_md1, blade_point_old);
+					VectorMA(cur_base2, step, curMD2, blade_point_new);
+					WP_SaberDamageTraceRequest(ent->s.number, blade_point_old, blade_point_new, qfalse, qtrue, saber_num,
+						blade_num, saberBladeRequests[num_batched++]);
+				}
+				gi.traceBatch(saberBladeTraces, saberBladeRequests, num_batched);
+			}
+
 			for (step = stepsize; step < ent->client->ps.saber[saber_num].blade[blade_num].length && step < ent->client
 				->ps.saber[saber_num].blade[blade_num].lengthOld; step += 12)
 			{
-				vec3_t blade_point_new;
-				vec3_t blade_point_old;
-				VectorMA(cur_base1, step, cur_md1, blade_point_old);
-				VectorMA(cur_base2, step, curMD2, blade_point_new);
-				if (WP_SaberDamageForTrace(ent->s.number, blade_point_old, blade_point_new, base_damage, curMD2,
-					qfalse, ent->client->ps.saber[saber_num].type, qtrue, saber_num,
-					blade_num))
+				qboolean hit;
+				if (next_batched < num_batched && saberHitFraction >= 1.0)
+				{
+					hit = WP_SaberDamageForTraceResult(saberBladeTraces[next_batched], saberBladeRequests[next_batched],
+						base_damage, curMD2, qfalse, ent->client->ps.saber[saber_num].type, saber_num, blade_num);
+					next_batched++;
+				}
+				else
+				{
+					vec3_t blade_point_new;
+					vec3_t blade_point_old;
+					VectorMA(cur_base1, step, cur_md1, blade_point_old);
+					VectorMA(cur_base2, step, curMD2, blade_point_new);
+					hit = WP_SaberDamageForTrace(ent->s.number, blade_point_old, blade_point_new, base_damage, curMD2,
+						qfalse, ent->client->ps.saber[saber_num].type, qtrue, saber_num,
+						blade_num);
+				}
+				if (hit)
 				{
 					hit_wall = qtrue;
 				}
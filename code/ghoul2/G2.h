@@ -64,6 +64,8 @@ int G2_GetSurfaceIndex(const CGhoul2Info* ghlInfo, const char* surfaceName);
 int G2_IsSurfaceRendered(const CGhoul2Info* ghlInfo, const char* surfaceName, const surfaceInfo_v& slist);
 
 // internal bone calls - G2_Bones.cpp
+void G2_Build_Bone_Name_Hash(model_s* mod);
+int G2_Find_Skel_Bone(const model_s* mod, const char* boneName);
 qboolean G2_Set_Bone_Angles(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const char* boneName, const float* angles, const int flags, const Eorientations up, const Eorientations left, const Eorientations forward, const int blend_time, const int current_time, const vec3_t offset);
 qboolean G2_Remove_Bone(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const char* boneName);
 qboolean G2_Remove_Bone_Index(boneInfo_v& blist, const int index);
@@ -223,6 +225,9 @@ int G2API_GetSurfaceRenderStatus(CGhoul2Info* ghlInfo, const char* surfaceName);
 // From tr_ghoul2.cpp
 void G2_ConstructGhoulSkeleton(CGhoul2Info_v& ghoul2, int frameNum, bool checkForNewOrigin, const vec3_t scale);
 void G2_GetBoltMatrixLow(CGhoul2Info& ghoul2, int boltNum, const vec3_t scale, mdxaBone_t& retMatrix);
+void G2_GetBoltMatrixCached(CGhoul2Info& ghoul2, int boltNum, const vec3_t scale, mdxaBone_t& retMatrix);
+void G2_InvalidateBoltCache(const CGhoul2Info* ghlInfo);
+void G2_InvalidateBoltCache(const CGhoul2Info_v& ghoul2);
 void G2_TimingModel(boneInfo_t& bone, const int current_time, const int numFramesInFile, int& current_frame, int& newFrame, float& lerp);
 
 bool G2_SetupModelPointers(CGhoul2Info_v& ghoul2); // returns true if any model is properly set up
@@ -24,9 +24,12 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // cmodel.c -- model loading
 
 #include "cm_local.h"
+#include "cm_patch.h"
 #include "qcommon/ojk_saved_game.h"
 #include "qcommon/ojk_saved_game_helper.h"
 
+#include <vector>
+
 #ifdef BSPC
 void SetPlaneSignbits(cplane_t* out) {
 	int	bits, j;
@@ -61,6 +64,10 @@ byte* cmod_base;
 cvar_t* cm_noAreas;
 cvar_t* cm_noCurves;
 cvar_t* cm_playerCurveClip;
+cvar_t* cm_traceThreads;
+cvar_t* cm_simdBrushes;
+cvar_t* cm_patchTree;
+cvar_t* cm_cacheMaps;
 #endif
 
 cmodel_t box_model;
@@ -441,6 +448,31 @@ void CMod_LoadLeafSurfaces(const lump_t* l, clipMap_t& cm)
 	}
 }
 
+/*
+=================
+CM_LoadBrushSidePlanes
+
+Builds cm.sidePlanes from the brush sides
+=================
+*/
+static void CM_LoadBrushSidePlanes(clipMap_t& cm)
+{
+	// +3 so the last side can be loaded four at a time too, the box hull fills in its own
+	const int num_planes = BOX_SIDES + cm.numBrushSides + 3;
+	auto plane_data = static_cast<float*>(Z_Malloc(7 * num_planes * sizeof(float), TAG_BSP, qtrue));
+	for (int i = 0; i < 3; i++)
+	{
+		cm.sidePlanes.normal[i] = plane_data + i * num_planes;
+		cm.sidePlanes.signMask[i] = reinterpret_cast<int*>(plane_data + (4 + i) * num_planes);
+	}
+	cm.sidePlanes.dist = plane_data + 3 * num_planes;
+
+	for (int i = 0; i < cm.numBrushSides; i++)
+	{
+		CM_SetBrushSidePlane(cm, i);
+	}
+}
+
 /*
 =================
 CMod_LoadBrushSides
@@ -471,32 +503,56 @@ void CMod_LoadBrushSides(const lump_t* l, clipMap_t& cm)
 		}
 		//		out->surfaceFlags = cm.shaders[out->shaderNum].surfaceFlags;
 	}
+
+	CM_LoadBrushSidePlanes(cm);
 }
 
 /*
 =================
-CMod_LoadEntityString
+CM_SetBrushSidePlane
+
+Copies a brush side's plane into the structure of arrays version
 =================
 */
-void CMod_LoadEntityString(const lump_t* l, clipMap_t& cm, const char* name)
+void CM_SetBrushSidePlane(const clipMap_t& cm, const int sidenum)
 {
-	fileHandle_t h;
-	char ent_name[MAX_QPATH];
+	const cplane_t* plane = cm.brushsides[sidenum].plane;
+
+	for (int i = 0; i < 3; i++)
+	{
+		cm.sidePlanes.normal[i][sidenum] = plane->normal[i];
+		cm.sidePlanes.signMask[i][sidenum] = plane->signbits & 1 << i ? ~0 : 0;
+	}
+	cm.sidePlanes.dist[sidenum] = plane->dist;
+}
 
-	// Attempt to load entities from an external .ent file if available
-	Q_strncpyz(ent_name, name, sizeof ent_name);
+/*
+=================
+CMod_LoadEntityString
+=================
+*/
+static void CMod_EntityFileName(const char* name, char* ent_name, const size_t ent_name_size)
+{
+	Q_strncpyz(ent_name, name, ent_name_size);
 	const size_t ent_name_len = strlen(ent_name);
 	ent_name[ent_name_len - 3] = 'e';
 	ent_name[ent_name_len - 2] = 'n';
 	ent_name[ent_name_len - 1] = 't';
-	const int i_entity_file_len = FS_FOpenFileRead(ent_name, &h, qfalse);
-	if (h)
-	{
-		cm.entityString = static_cast<char*>(Z_Malloc(i_entity_file_len + 1, TAG_BSP, qfalse));
-		cm.numEntityChars = i_entity_file_len + 1;
-		FS_Read(cm.entityString, i_entity_file_len, h);
-		FS_FCloseFile(h);
-		cm.entityString[i_entity_file_len] = '\0';
+}
+
+// ent_file is an FS_ReadFile() buffer of the external .ent file if there was one (which this takes ownership of), else NULL
+void CMod_LoadEntityString(const lump_t* l, clipMap_t& cm, const char* name, char* ent_file, const long ent_file_len)
+{
+	// Use entities from an external .ent file if available
+	if (ent_file)
+	{
+		char ent_name[MAX_QPATH];
+		CMod_EntityFileName(name, ent_name, sizeof ent_name);
+
+		// FS_ReadFile already 0-terminated it, so just keep the buffer
+		Z_MorphMallocTag(ent_file, TAG_BSP);
+		cm.entityString = ent_file;
+		cm.numEntityChars = ent_file_len + 1;
 		Com_Printf("Loaded entities from %s\n", ent_name);
 		return;
 	}
@@ -557,6 +613,10 @@ void CMod_LoadPatches(const lump_t* surfs, const lump_t* verts, clipMap_t& cm)
 	if (verts->filelen % sizeof * dv)
 		Com_Error(ERR_DROP, "MOD_LoadBmodel: funny lump size");
 
+	int num_patches = 0;
+	c_totalPatchFacets = c_totalPatchTreeNodes = c_totalPatchTreeBytes = 0;
+	const int start_time = Sys_Milliseconds();
+
 	// scan through all the surfaces, but only load patches,
 	// not planar faces
 	for (int i = 0; i < count; i++, in++)
@@ -594,7 +654,403 @@ void CMod_LoadPatches(const lump_t* surfs, const lump_t* verts, clipMap_t& cm)
 
 		// create the internal facet structure
 		patch->pc = CM_GeneratePatchCollide(width, height, points);
+		num_patches++;
+	}
+
+	Com_DPrintf("%d patches, %d facets, %d facet tree nodes (%d KB), %d msec\n", num_patches, c_totalPatchFacets,
+		c_totalPatchTreeNodes, c_totalPatchTreeBytes / 1024, Sys_Milliseconds() - start_time);
+}
+
+//==================================================================
+
+/*
+===============================================================================
+
+CLIP MAP CACHE
+
+Most of the time building a clip map goes on patch facet generation, so the
+finished world clipMap_t is written to the homepath beside the bsp and read
+straight back on later loads, keyed on the bsp checksum. Pointers are stored
+as byte offsets from the start of the file (0 for NULL), so the file doesn't
+care where it lands, and get fixed up in place after the read.
+
+===============================================================================
+*/
+
+#define CM_CACHE_IDENT INT_ID('C','M','C','H')
+#define CM_CACHE_VERSION 1
+constexpr auto CM_CACHE_ALIGN = 16;
+
+using cmCacheHeader_t = struct
+{
+	int ident;
+	int version;
+	int pointerSize; // a cache is only good for builds like the one that wrote it
+	int bspChecksum;
+	int bspLength;
+	int outcast; // com_outcast changes brush contents
+	int length; // of the whole file
+	clipMap_t cm; // pointers as offsets
+};
+
+static void CM_MapCacheFileName(const char* name, char* cache_name, const size_t cache_name_size)
+{
+	COM_StripExtension(name, cache_name, cache_name_size);
+	Q_strcat(cache_name, cache_name_size, ".cmc");
+}
+
+static int CM_VisibilityBytes(const clipMap_t& cm)
+{
+	return cm.vised ? cm.numClusters * cm.clusterBytes : cm.clusterBytes;
+}
+
+// copies count elements to the end of data, followed by extra zeroed ones, and returns their offset
+template <typename T>
+static size_t CM_CacheAppend(std::vector<byte>& data, const T* src, const int count, const int extra = 0)
+{
+	const size_t offset = data.size() + CM_CACHE_ALIGN - 1 & ~static_cast<size_t>(CM_CACHE_ALIGN - 1);
+	data.resize(offset + (count + extra) * sizeof(T));
+	if (count)
+	{
+		memcpy(data.data() + offset, src, count * sizeof(T));
+	}
+	return offset;
+}
+
+template <typename T>
+static T* CM_CacheData(std::vector<byte>& data, const size_t offset)
+{
+	return reinterpret_cast<T*>(data.data() + offset);
+}
+
+template <typename T>
+static T* CM_CacheOffset(const size_t offset)
+{
+	return reinterpret_cast<T*>(offset);
+}
+
+/*
+=================
+CM_WriteMapCache
+
+Must be called straight after the lumps are loaded, before the box hull
+or any traces have touched the clip map
+=================
+*/
+static void CM_WriteMapCache(const char* name, const int checksum, const int bsp_len, const clipMap_t& cm)
+{
+	if (&cm != &cmg || !cm_cacheMaps->integer)
+	{
+		return;
+	}
+
+	std::vector<byte> data(sizeof(cmCacheHeader_t));
+	cmCacheHeader_t header{};
+	header.ident = CM_CACHE_IDENT;
+	header.version = CM_CACHE_VERSION;
+	header.pointerSize = sizeof(void*);
+	header.bspChecksum = checksum;
+	header.bspLength = bsp_len;
+	header.outcast = com_outcast->integer;
+
+	// the counts come across as they are, the entity string and area state get rebuilt on load
+	clipMap_t& out = header.cm;
+	out = cm;
+	out.name[0] = '\0';
+	out.sidePlanes = {};
+	out.numEntityChars = 0;
+	out.entityString = nullptr;
+	out.areas = nullptr;
+	out.areaPortals = nullptr;
+	out.floodvalid = 0;
+	out.checkcount = 0;
+
+	const size_t shaders = CM_CacheAppend(data, cm.shaders, cm.numShaders, 1);
+	const size_t planes = CM_CacheAppend(data, cm.planes, cm.numplanes, BOX_PLANES);
+	const size_t sides = CM_CacheAppend(data, cm.brushsides, cm.numBrushSides, BOX_SIDES);
+	const size_t brushes = CM_CacheAppend(data, cm.brushes, cm.numBrushes, BOX_BRUSHES);
+	const size_t nodes = CM_CacheAppend(data, cm.nodes, cm.numNodes);
+	const size_t leafs = CM_CacheAppend(data, cm.leafs, cm.numLeafs, BOX_LEAFS);
+	const size_t leaf_brushes = CM_CacheAppend(data, cm.leafbrushes, cm.numLeafBrushes, BOX_BRUSHES);
+	const size_t leaf_surfaces = CM_CacheAppend(data, cm.leafsurfaces, cm.numLeafSurfaces);
+	const size_t cmodels = CM_CacheAppend(data, cm.cmodels, cm.numSubModels);
+	const size_t visibility = CM_CacheAppend(data, cm.visibility, CM_VisibilityBytes(cm));
+	const size_t surfaces = CM_CacheAppend(data, cm.surfaces, cm.numSurfaces);
+
+	out.shaders = CM_CacheOffset<CCMShader>(shaders);
+	out.planes = CM_CacheOffset<cplane_t>(planes);
+	out.brushsides = CM_CacheOffset<cbrushside_t>(sides);
+	out.brushes = CM_CacheOffset<cbrush_t>(brushes);
+	out.nodes = CM_CacheOffset<cNode_t>(nodes);
+	out.leafs = CM_CacheOffset<cLeaf_t>(leafs);
+	out.leafbrushes = CM_CacheOffset<int>(leaf_brushes);
+	out.leafsurfaces = CM_CacheOffset<int>(leaf_surfaces);
+	out.cmodels = CM_CacheOffset<cmodel_t>(cmodels);
+	out.visibility = CM_CacheOffset<byte>(visibility);
+	out.surfaces = CM_CacheOffset<cPatch_t*>(surfaces);
+
+	for (int i = 0; i < cm.numShaders; i++)
+	{
+		CM_CacheData<CCMShader>(data, shaders)[i].SetNext(nullptr);
+	}
+
+	for (int i = 0; i < cm.numBrushSides; i++)
+	{
+		CM_CacheData<cbrushside_t>(data, sides)[i].plane = CM_CacheOffset<cplane_t>(planes + (cm.brushsides[i].plane - cm.planes) * sizeof(cplane_t));
+	}
+
+	for (int i = 0; i < cm.numBrushes; i++)
+	{
+		CM_CacheData<cbrush_t>(data, brushes)[i].sides = CM_CacheOffset<cbrushside_t>(sides + (cm.brushes[i].sides - cm.brushsides) * sizeof(cbrushside_t));
+	}
+
+	for (int i = 0; i < cm.numNodes; i++)
+	{
+		CM_CacheData<cNode_t>(data, nodes)[i].plane = CM_CacheOffset<cplane_t>(planes + (cm.nodes[i].plane - cm.planes) * sizeof(cplane_t));
+	}
+
+	// submodel leafs index their own arrays, which only pose as part of leafbrushes and leafsurfaces,
+	// so they go in the file as offsets of their own
+	for (int i = 0; i < cm.numSubModels; i++)
+	{
+		const cLeaf_t& leaf = cm.cmodels[i].leaf;
+		if (leaf.numLeafBrushes)
+		{
+			const size_t offset = CM_CacheAppend(data, cm.leafbrushes + leaf.firstLeafBrush, leaf.numLeafBrushes);
+			CM_CacheData<cmodel_t>(data, cmodels)[i].leaf.firstLeafBrush = offset;
+		}
+		if (leaf.numLeafSurfaces)
+		{
+			const size_t offset = CM_CacheAppend(data, cm.leafsurfaces + leaf.firstLeafSurface, leaf.numLeafSurfaces);
+			CM_CacheData<cmodel_t>(data, cmodels)[i].leaf.firstLeafSurface = offset;
+		}
+	}
+
+	for (int i = 0; i < cm.numSurfaces; i++)
+	{
+		const cPatch_t* patch = cm.surfaces[i];
+		if (!patch)
+		{
+			continue;
+		}
+
+		const patchCollide_t* pc = patch->pc;
+		const size_t patch_offset = CM_CacheAppend(data, patch, 1);
+		const size_t pc_offset = CM_CacheAppend(data, pc, 1);
+		const size_t pc_planes = CM_CacheAppend(data, pc->planes, pc->numplanes);
+		const size_t pc_facets = pc->facets ? CM_CacheAppend(data, pc->facets, pc->numFacets) : 0;
+		const size_t tree_nodes = pc->treeNodes ? CM_CacheAppend(data, pc->treeNodes, pc->numTreeNodes) : 0;
+		const size_t tree_facets = pc->treeFacets ? CM_CacheAppend(data, pc->treeFacets, pc->numFacets) : 0;
+
+		CM_CacheData<cPatch_t*>(data, surfaces)[i] = CM_CacheOffset<cPatch_t>(patch_offset);
+		CM_CacheData<cPatch_t>(data, patch_offset)->pc = CM_CacheOffset<patchCollide_t>(pc_offset);
+		auto pc_out = CM_CacheData<patchCollide_t>(data, pc_offset);
+		pc_out->planes = CM_CacheOffset<patchPlane_t>(pc_planes);
+		pc_out->facets = CM_CacheOffset<facet_t>(pc_facets);
+		pc_out->treeNodes = CM_CacheOffset<patchTreeNode_t>(tree_nodes);
+		pc_out->treeFacets = CM_CacheOffset<int>(tree_facets);
+	}
+
+	header.length = static_cast<int>(data.size());
+	memcpy(data.data(), &header, sizeof header);
+
+	char cache_name[MAX_QPATH];
+	CM_MapCacheFileName(name, cache_name, sizeof cache_name);
+	const fileHandle_t f = FS_FOpenFileWrite(cache_name);
+	if (!f)
+	{
+		Com_DPrintf("Couldn't write clip map cache %s\n", cache_name);
+		return;
 	}
+	FS_Write(data.data(), header.length, f);
+	FS_FCloseFile(f);
+
+	Com_DPrintf("Wrote clip map cache %s (%d KB)\n", cache_name, header.length / 1024);
+}
+
+// turns an offset read from the cache back into a pointer, failing if count elements there would run off the end
+template <typename T>
+static bool CM_CacheRelocate(T*& ptr, byte* base, const size_t length, const int count)
+{
+	const auto offset = reinterpret_cast<size_t>(ptr);
+	if (!offset)
+	{
+		return true;
+	}
+	if (offset < sizeof(cmCacheHeader_t) || offset > length || count < 0
+		|| static_cast<size_t>(count) > (length - offset) / sizeof(T))
+	{
+		return false;
+	}
+	ptr = reinterpret_cast<T*>(base + offset);
+	return true;
+}
+
+static bool CM_RelocateMapCache(byte* base, const size_t length)
+{
+	clipMap_t& cm = reinterpret_cast<cmCacheHeader_t*>(base)->cm;
+
+	if (!CM_CacheRelocate(cm.shaders, base, length, cm.numShaders + 1)
+		|| !CM_CacheRelocate(cm.planes, base, length, cm.numplanes + BOX_PLANES)
+		|| !CM_CacheRelocate(cm.brushsides, base, length, cm.numBrushSides + BOX_SIDES)
+		|| !CM_CacheRelocate(cm.brushes, base, length, cm.numBrushes + BOX_BRUSHES)
+		|| !CM_CacheRelocate(cm.nodes, base, length, cm.numNodes)
+		|| !CM_CacheRelocate(cm.leafs, base, length, cm.numLeafs + BOX_LEAFS)
+		|| !CM_CacheRelocate(cm.leafbrushes, base, length, cm.numLeafBrushes + BOX_BRUSHES)
+		|| !CM_CacheRelocate(cm.leafsurfaces, base, length, cm.numLeafSurfaces)
+		|| !CM_CacheRelocate(cm.cmodels, base, length, cm.numSubModels)
+		|| !CM_CacheRelocate(cm.visibility, base, length, CM_VisibilityBytes(cm))
+		|| !CM_CacheRelocate(cm.surfaces, base, length, cm.numSurfaces))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < cm.numBrushSides; i++)
+	{
+		if (!CM_CacheRelocate(cm.brushsides[i].plane, base, length, 1))
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < cm.numBrushes; i++)
+	{
+		if (!CM_CacheRelocate(cm.brushes[i].sides, base, length, cm.brushes[i].numsides))
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < cm.numNodes; i++)
+	{
+		if (!CM_CacheRelocate(cm.nodes[i].plane, base, length, 1))
+		{
+			return false;
+		}
+	}
+
+	for (int i = 0; i < cm.numSubModels; i++)
+	{
+		cLeaf_t& leaf = cm.cmodels[i].leaf;
+		if (leaf.numLeafBrushes)
+		{
+			auto indexes = CM_CacheOffset<int>(leaf.firstLeafBrush);
+			if (!CM_CacheRelocate(indexes, base, length, leaf.numLeafBrushes))
+			{
+				return false;
+			}
+			leaf.firstLeafBrush = indexes - cm.leafbrushes;
+		}
+		if (leaf.numLeafSurfaces)
+		{
+			auto indexes = CM_CacheOffset<int>(leaf.firstLeafSurface);
+			if (!CM_CacheRelocate(indexes, base, length, leaf.numLeafSurfaces))
+			{
+				return false;
+			}
+			leaf.firstLeafSurface = indexes - cm.leafsurfaces;
+		}
+	}
+
+	for (int i = 0; i < cm.numSurfaces; i++)
+	{
+		if (!CM_CacheRelocate(cm.surfaces[i], base, length, 1))
+		{
+			return false;
+		}
+
+		cPatch_t* patch = cm.surfaces[i];
+		if (!patch)
+		{
+			continue;
+		}
+		if (!CM_CacheRelocate(patch->pc, base, length, 1))
+		{
+			return false;
+		}
+
+		patchCollide_t* pc = patch->pc;
+		if (!CM_CacheRelocate(pc->planes, base, length, pc->numplanes)
+			|| !CM_CacheRelocate(pc->facets, base, length, pc->numFacets)
+			|| !CM_CacheRelocate(pc->treeNodes, base, length, pc->numTreeNodes)
+			|| !CM_CacheRelocate(pc->treeFacets, base, length, pc->numFacets))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+=================
+CM_LoadMapCache
+
+Fills in everything the lumps would have but the entity string, or returns
+qfalse if there's no cache for this exact bsp
+=================
+*/
+static qboolean CM_LoadMapCache(const char* name, const int checksum, const int bsp_len, clipMap_t& cm)
+{
+	if (&cm != &cmg || !cm_cacheMaps->integer)
+	{
+		return qfalse;
+	}
+
+	const int start_time = Sys_Milliseconds();
+
+	char cache_name[MAX_QPATH];
+	CM_MapCacheFileName(name, cache_name, sizeof cache_name);
+	void* buffer;
+	const long len = FS_ReadFile(cache_name, &buffer);
+	if (!buffer)
+	{
+		return qfalse;
+	}
+
+	const auto header = static_cast<cmCacheHeader_t*>(buffer);
+	if (len < static_cast<long>(sizeof * header)
+		|| header->ident != CM_CACHE_IDENT
+		|| header->version != CM_CACHE_VERSION
+		|| header->pointerSize != static_cast<int>(sizeof(void*))
+		|| header->bspChecksum != checksum
+		|| header->bspLength != bsp_len
+		|| header->outcast != com_outcast->integer
+		|| header->length != len)
+	{
+		FS_FreeFile(buffer);
+		return qfalse;
+	}
+
+	if (!CM_RelocateMapCache(static_cast<byte*>(buffer), len))
+	{
+		Com_DPrintf("Ignoring bad clip map cache %s\n", cache_name);
+		FS_FreeFile(buffer);
+		return qfalse;
+	}
+
+	// it lives as long as the rest of the map now
+	Z_MorphMallocTag(buffer, TAG_BSP);
+	cm = header->cm;
+
+	cm.areas = static_cast<cArea_t*>(Z_Malloc(cm.numAreas * sizeof * cm.areas, TAG_BSP, qtrue));
+	cm.areaPortals = static_cast<int*>(Z_Malloc(cm.numAreas * cm.numAreas * sizeof * cm.areaPortals, TAG_BSP, qtrue));
+	CM_LoadBrushSidePlanes(cm);
+
+	for (int i = 0; i < cm.numBrushes; i++)
+	{
+		CM_OrOfAllContentsFlagsInMap |= cm.brushes[i].contents;
+	}
+	for (int i = 0; i < cm.numSurfaces; i++)
+	{
+		if (cm.surfaces[i])
+		{
+			CM_OrOfAllContentsFlagsInMap |= cm.surfaces[i]->contents;
+		}
+	}
+
+	Com_DPrintf("Loaded clip map cache %s, %d msec\n", cache_name, Sys_Milliseconds() - start_time);
+	return qtrue;
 }
 
 //==================================================================
@@ -640,7 +1096,7 @@ qboolean CM_DeleteCachedMap(const qboolean b_guaranteed_ok_to_delete)
 		//
 		if (gpvCachedMapDiskImage)
 		{
-			Z_Free(gpvCachedMapDiskImage);
+			FS_FreeFile(gpvCachedMapDiskImage);
 			gpvCachedMapDiskImage = nullptr;
 
 			b_actually_freed_something = qtrue;
@@ -670,6 +1126,10 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 	cm_noAreas = Cvar_Get("cm_noAreas", "0", CVAR_CHEAT);
 	cm_noCurves = Cvar_Get("cm_noCurves", "0", CVAR_CHEAT);
 	cm_playerCurveClip = Cvar_Get("cm_playerCurveClip", "1", CVAR_ARCHIVE_ND | CVAR_CHEAT);
+	cm_traceThreads = Cvar_Get("cm_traceThreads", "2", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	cm_simdBrushes = Cvar_Get("cm_simdBrushes", "1", CVAR_ARCHIVE_ND);
+	cm_patchTree = Cvar_Get("cm_patchTree", "1", CVAR_ARCHIVE_ND);
+	cm_cacheMaps = Cvar_Get("cm_cacheMaps", "1", CVAR_ARCHIVE_ND);
 #endif
 	Com_DPrintf("CM_LoadMap( %s, %i )\n", name, clientload);
 
@@ -688,7 +1148,7 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 			(gsCachedMapDiskImage[0] == '\0' || strcmp(gsCachedMapDiskImage, name) != 0)
 			)
 		{
-			Z_Free(gpvCachedMapDiskImage);
+			FS_FreeFile(gpvCachedMapDiskImage);
 			gpvCachedMapDiskImage = nullptr;
 			gsCachedMapDiskImage[0] = '\0';
 
@@ -740,12 +1200,31 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 
 		// load the file into a buffer that we either discard as usual at the bottom, or if we've got enough memory
 		//	then keep it long enough to save the renderer re-loading it, then discard it after that.
+		//	If the bsp is stored uncompressed in a pk3 then the "buffer" is just a view of the pk3, no copy...
+		//	Otherwise it's read (and inflated) alongside any external .ent file, both at once.
 		//
-		fileHandle_t h;
-		const int i_bsp_len = FS_FOpenFileRead(name, &h, qfalse);
-		if (!h)
+		char ent_name[MAX_QPATH];
+		CMod_EntityFileName(name, ent_name, sizeof ent_name);
+		const char* psz_files[2] = { ent_name, name };
+		void* pv_files[2];
+		long l_file_lens[2];
+
+		void* pv_bsp_data;
+		int i_bsp_len = FS_MapFile(name, &pv_bsp_data);
+		FS_ReadFiles(psz_files, pv_files, l_file_lens, pv_bsp_data ? 1 : 2);
+		if (!pv_bsp_data)
 		{
-			Com_Error(ERR_DROP, "Couldn't load %s", name);
+			pv_bsp_data = pv_files[1];
+			i_bsp_len = l_file_lens[1];
+			if (!pv_bsp_data)
+			{
+				if (pv_files[0])
+				{
+					FS_FreeFile(pv_files[0]);
+				}
+				Com_Error(ERR_DROP, "Couldn't load %s", name);
+			}
+			Z_MorphMallocTag(pv_bsp_data, TAG_BSP_DISKIMAGE);
 		}
 		//rww - only do this when not loading a sub-bsp!
 		if (&cm == &cmg)
@@ -754,21 +1233,17 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 			{
 				//didn't get cleared elsewhere so free it before we allocate the pointer again
 				//Maps with terrain will allow this to happen because they want everything to be cleared out (going between terrain and no-terrain is messy)
-				Z_Free(gpvCachedMapDiskImage);
+				FS_FreeFile(gpvCachedMapDiskImage);
 			}
 			gsCachedMapDiskImage[0] = '\0'; // flag that map isn't valid, until name is filled in
-			gpvCachedMapDiskImage = Z_Malloc(i_bsp_len, TAG_BSP_DISKIMAGE, qfalse);
-			FS_Read(gpvCachedMapDiskImage, i_bsp_len, h);
-			FS_FCloseFile(h);
+			gpvCachedMapDiskImage = pv_bsp_data;
 
 			buf = static_cast<int*>(gpvCachedMapDiskImage); // so the rest of the code works as normal
 		}
 		else
 		{
 			//otherwise, read straight in..
-			sub_bsp_data = Z_Malloc(i_bsp_len, TAG_BSP_DISKIMAGE, qfalse);
-			FS_Read(sub_bsp_data, i_bsp_len, h);
-			FS_FCloseFile(h);
+			sub_bsp_data = pv_bsp_data;
 
 			buf = static_cast<int*>(sub_bsp_data);
 		}
@@ -785,8 +1260,15 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 
 		if (header.version != BSP_VERSION)
 		{
-			Z_Free(gpvCachedMapDiskImage);
-			gpvCachedMapDiskImage = nullptr;
+			if (pv_files[0])
+			{
+				FS_FreeFile(pv_files[0]);
+			}
+			if (gpvCachedMapDiskImage)
+			{
+				FS_FreeFile(gpvCachedMapDiskImage);
+				gpvCachedMapDiskImage = nullptr;
+			}
 
 			Com_Error(ERR_DROP, "CM_LoadMap: %s has wrong version number (%i should be %i)"
 				, name, header.version, BSP_VERSION);
@@ -794,19 +1276,24 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 
 		cmod_base = (byte*)buf;
 
-		// load into heap
-		CMod_LoadShaders(&header.lumps[LUMP_SHADERS], cm);
-		CMod_LoadLeafs(&header.lumps[LUMP_LEAFS], cm);
-		CMod_LoadLeafBrushes(&header.lumps[LUMP_LEAFBRUSHES], cm);
-		CMod_LoadLeafSurfaces(&header.lumps[LUMP_LEAFSURFACES], cm);
-		CMod_LoadPlanes(&header.lumps[LUMP_PLANES], cm);
-		CMod_LoadBrushSides(&header.lumps[LUMP_BRUSHSIDES], cm);
-		CMod_LoadBrushes(&header.lumps[LUMP_BRUSHES], cm);
-		CMod_LoadSubmodels(&header.lumps[LUMP_MODELS], cm);
-		CMod_LoadNodes(&header.lumps[LUMP_NODES], cm);
-		CMod_LoadEntityString(&header.lumps[LUMP_ENTITIES], cm, name);
-		CMod_LoadVisibility(&header.lumps[LUMP_VISIBILITY], cm);
-		CMod_LoadPatches(&header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm);
+		// load into heap, unless it was already built from this exact bsp last time
+		if (!CM_LoadMapCache(name, last_checksum, i_bsp_len, cm))
+		{
+			CMod_LoadShaders(&header.lumps[LUMP_SHADERS], cm);
+			CMod_LoadLeafs(&header.lumps[LUMP_LEAFS], cm);
+			CMod_LoadLeafBrushes(&header.lumps[LUMP_LEAFBRUSHES], cm);
+			CMod_LoadLeafSurfaces(&header.lumps[LUMP_LEAFSURFACES], cm);
+			CMod_LoadPlanes(&header.lumps[LUMP_PLANES], cm);
+			CMod_LoadBrushSides(&header.lumps[LUMP_BRUSHSIDES], cm);
+			CMod_LoadBrushes(&header.lumps[LUMP_BRUSHES], cm);
+			CMod_LoadSubmodels(&header.lumps[LUMP_MODELS], cm);
+			CMod_LoadNodes(&header.lumps[LUMP_NODES], cm);
+			CMod_LoadVisibility(&header.lumps[LUMP_VISIBILITY], cm);
+			CMod_LoadPatches(&header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm);
+
+			CM_WriteMapCache(name, last_checksum, i_bsp_len, cm);
+		}
+		CMod_LoadEntityString(&header.lumps[LUMP_ENTITIES], cm, name, static_cast<char*>(pv_files[0]), l_file_lens[0]);
 
 		TotalSubModels += cm.numSubModels;
 
@@ -816,7 +1303,7 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 		//
 		if (Sys_LowPhysicalMemory())
 		{
-			Z_Free(gpvCachedMapDiskImage);
+			FS_FreeFile(gpvCachedMapDiskImage);
 			gpvCachedMapDiskImage = nullptr;
 		}
 		else
@@ -827,7 +1314,7 @@ static void CM_LoadMap_Actual(const char* name, const qboolean clientload, int*
 
 		if (sub_bsp_data)
 		{
-			Z_Free(sub_bsp_data);
+			FS_FreeFile(sub_bsp_data);
 		}
 
 		if (&cm == &cmg)
@@ -903,6 +1390,8 @@ void CM_ClearMap()
 {
 	CM_OrOfAllContentsFlagsInMap = CONTENTS_BODY;
 
+	CM_ShutdownTraceBatch();
+
 	memset(&cmg, 0, sizeof cmg);
 	CM_ClearLevelPatches();
 
@@ -1064,6 +1553,11 @@ void CM_InitBoxHull()
 
 		SetPlaneSignbits(p);
 	}
+
+	for (int i = 0; i < BOX_SIDES; i++)
+	{
+		CM_SetBrushSidePlane(cmg, cmg.numBrushSides + i);
+	}
 }
 
 /*
@@ -1090,6 +1584,11 @@ clipHandle_t CM_TempBoxModel(const vec3_t mins, const vec3_t maxs)
 	box_planes[10].dist = mins[2];
 	box_planes[11].dist = -mins[2];
 
+	for (int i = 0; i < BOX_SIDES; i++)
+	{
+		CM_SetBrushSidePlane(cmg, cmg.numBrushSides + i);
+	}
+
 	VectorCopy(mins, box_brush->bounds[0]);
 	VectorCopy(maxs, box_brush->bounds[1]);
 
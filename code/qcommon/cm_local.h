@@ -65,6 +65,15 @@ using cbrushside_t = struct cbrushside_s
 	int shaderNum;
 };
 
+// brush side planes again as structure of arrays, indexed like clipMap_t::brushsides, so
+// CM_TraceThroughBrush can test four sides at a time
+using cbrushsidePlanes_t = struct
+{
+	float* normal[3];
+	float* dist;
+	int* signMask[3]; // ~0 where the normal component is negative (its signbits bit), else 0
+};
+
 using cbrush_t = struct cbrush_s
 {
 	int shaderNum; // the shader that determined the contents
@@ -72,7 +81,7 @@ using cbrush_t = struct cbrush_s
 	vec3_t bounds[2];
 	cbrushside_t* sides;
 	unsigned short numsides;
-	unsigned short checkcount; // to avoid repeated testings
+	unsigned short checkcount; // to avoid repeated testings in CM_BoxBrushes, traces keep their own
 };
 
 class CCMShader
@@ -94,7 +103,6 @@ public:
 
 using cPatch_t = struct
 {
-	int checkcount; // to avoid repeated testings
 	int surfaceFlags;
 	int contents;
 	struct patchCollide_s* pc;
@@ -116,6 +124,7 @@ using clipMap_t = struct
 
 	int numBrushSides;
 	cbrushside_t* brushsides;
+	cbrushsidePlanes_t sidePlanes;
 
 	int numplanes;
 	cplane_t* planes;
@@ -154,7 +163,7 @@ using clipMap_t = struct
 	cPatch_t** surfaces; // non-patches will be NULL
 
 	int floodvalid;
-	int checkcount; // incremented on each trace
+	int checkcount; // incremented on each CM_BoxBrushes
 };
 
 // keep 1/8 unit away to keep the position valid before network snapping
@@ -167,6 +176,11 @@ extern int c_traces, c_brush_traces, c_patch_traces;
 extern cvar_t* cm_noAreas;
 extern cvar_t* cm_noCurves;
 extern cvar_t* cm_playerCurveClip;
+extern cvar_t* cm_traceThreads;
+extern cvar_t* cm_simdBrushes;
+extern cvar_t* cm_patchTree;
+extern cvar_t* cm_cacheMaps;
+extern thread_local bool cm_traceWorker;
 
 extern clipMap_t SubBSP[MAX_SUB_BSP];
 extern int NumSubBSP;
@@ -208,6 +222,8 @@ using traceWork_t = struct traceWork_s
 	bool startout;
 	bool getout;
 
+	struct traceVisited_s* visited; // brushes and patches this trace has already tested
+
 	trace_t trace; // returned from trace call
 	// make sure nothing goes under here for Ghoul2 collision purposes
 };
@@ -233,6 +249,7 @@ void CM_CleanLeafCache();
 
 // cm_load.c
 void CM_ModelBounds(clipHandle_t model, vec3_t mins, vec3_t maxs);
+void CM_SetBrushSidePlane(const clipMap_t& cm, int sidenum);
 
 // cm_patch.c
 
@@ -240,6 +257,7 @@ patchCollide_s* CM_GeneratePatchCollide(int width, int height, vec3_t* points);
 void CM_TraceThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc);
 qboolean CM_PositionTestInPatchCollide(const traceWork_t* tw, const patchCollide_s* pc);
 void CM_ClearLevelPatches();
+extern int c_totalPatchFacets, c_totalPatchTreeNodes, c_totalPatchTreeBytes;
 
 //cm_trace.cpp
 void CM_CalcExtents(const vec3_t start, const vec3_t end, const traceWork_t* tw, vec3pair_t bounds);
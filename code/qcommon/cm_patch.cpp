@@ -24,6 +24,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "cm_local.h"
 #include "cm_patch.h"
 
+#include <algorithm>
+
 //#define	CULL_BBOX
 
 /*
@@ -106,6 +108,9 @@ typedef struct {
 int	c_totalPatchBlocks;
 int	c_totalPatchSurfaces;
 int	c_totalPatchEdges;
+int	c_totalPatchFacets;
+int	c_totalPatchTreeNodes;
+int	c_totalPatchTreeBytes;
 
 static const patchCollide_t* debugPatchCollide;
 static const facet_t* debugFacet;
@@ -968,6 +973,204 @@ void CM_AddFacetBevels(facet_t* facet) {
 #endif //BSPC
 }
 
+/*
+==================
+CM_FacetBounds
+
+The bounds of the facet's surface inside all its borders, bevels included, plus a
+unit for epsilons. Since the bevels include the axial planes, nothing outside
+them once they're expanded for a trace's box can touch the facet.
+==================
+*/
+static void CM_FacetBounds(const facet_t* facet, const patchCollide_t* pf, vec3_t bounds[2]) {
+	float plane[4];
+
+	VectorCopy4(planes[facet->surfacePlane].plane, plane);
+	winding_t* w = BaseWindingForPlane(plane, plane[3]);
+	for (int j = 0; j < facet->numBorders && w; j++) {
+		if (facet->borderPlanes[j] == facet->surfacePlane) continue;
+		VectorCopy4(planes[facet->borderPlanes[j]].plane, plane);
+		if (!facet->borderInward[j]) {
+			VectorSubtract(vec3_origin, plane, plane);
+			plane[3] = -plane[3];
+		}
+		ChopWindingInPlace(&w, plane, plane[3], 0.1f);
+	}
+
+	if (w) {
+		WindingBounds(w, bounds[0], bounds[1]);
+		FreeWinding(w);
+	}
+	else {
+		// can't happen to a facet that passed CM_ValidateFacet, but the whole patch is safe
+		VectorCopy(pf->bounds[0], bounds[0]);
+		VectorCopy(pf->bounds[1], bounds[1]);
+	}
+
+	for (int j = 0; j < 3; j++) {
+		bounds[0][j] -= 1;
+		bounds[1][j] += 1;
+	}
+}
+
+/*
+==================
+CM_BuildPatchTree_r
+
+Median split on the longest axis of the facet centres
+==================
+*/
+static void CM_BuildPatchTree_r(patchTreeNode_t* nodes, int* num_nodes, const int node_num, int* tree_facets,
+	const vec3_t (*facet_bounds)[2], const int first, const int num) {
+	patchTreeNode_t* node = &nodes[node_num];
+	vec3_t centre_mins, centre_maxs;
+	int i;
+
+	ClearBounds(node->bounds[0], node->bounds[1]);
+	ClearBounds(centre_mins, centre_maxs);
+	for (i = first; i < first + num; i++) {
+		vec3_t centre;
+		const vec3_t* bounds = facet_bounds[tree_facets[i]];
+		AddPointToBounds(bounds[0], node->bounds[0], node->bounds[1]);
+		AddPointToBounds(bounds[1], node->bounds[0], node->bounds[1]);
+		VectorAdd(bounds[0], bounds[1], centre);
+		AddPointToBounds(centre, centre_mins, centre_maxs);
+	}
+
+	if (num <= PATCH_TREE_LEAF_FACETS) {
+		node->children = 0;
+		node->firstFacet = first;
+		node->numFacets = num;
+		return;
+	}
+
+	int axis = 0;
+	for (i = 1; i < 3; i++) {
+		if (centre_maxs[i] - centre_mins[i] > centre_maxs[axis] - centre_mins[axis]) {
+			axis = i;
+		}
+	}
+
+	const int half = num / 2;
+	std::nth_element(tree_facets + first, tree_facets + first + half, tree_facets + first + num,
+		[facet_bounds, axis](const int a, const int b) {
+			return facet_bounds[a][0][axis] + facet_bounds[a][1][axis] < facet_bounds[b][0][axis] + facet_bounds[b][1][axis];
+		});
+
+	const int children = *num_nodes;
+	*num_nodes += 2;
+	node->children = children;
+	node->firstFacet = 0;
+	node->numFacets = 0;
+
+	CM_BuildPatchTree_r(nodes, num_nodes, children, tree_facets, facet_bounds, first, half);
+	CM_BuildPatchTree_r(nodes, num_nodes, children + 1, tree_facets, facet_bounds, first + half, num - half);
+}
+
+/*
+==================
+CM_BuildPatchTree
+==================
+*/
+static void CM_BuildPatchTree(patchCollide_t* pf) {
+	pf->numTreeNodes = 0;
+	pf->treeNodes = nullptr;
+	pf->treeFacets = nullptr;
+
+	if (pf->numFacets < PATCH_TREE_MIN_FACETS) {
+		return;
+	}
+
+	const auto facet_bounds = static_cast<vec3_t(*)[2]>(Z_Malloc(pf->numFacets * sizeof(vec3_t[2]), TAG_TEMP_WORKSPACE, qfalse));
+	const auto nodes = static_cast<patchTreeNode_t*>(Z_Malloc(2 * pf->numFacets * sizeof(patchTreeNode_t), TAG_TEMP_WORKSPACE, qfalse));
+	pf->treeFacets = static_cast<int*>(Z_Malloc(pf->numFacets * sizeof(int), TAG_BSP, qfalse));
+
+	for (int i = 0; i < pf->numFacets; i++) {
+		CM_FacetBounds(&pf->facets[i], pf, facet_bounds[i]);
+		pf->treeFacets[i] = i;
+	}
+
+	int num_nodes = 1;
+	CM_BuildPatchTree_r(nodes, &num_nodes, 0, pf->treeFacets, facet_bounds, 0, pf->numFacets);
+
+	pf->numTreeNodes = num_nodes;
+	pf->treeNodes = static_cast<patchTreeNode_t*>(Z_Malloc(num_nodes * sizeof(patchTreeNode_t), TAG_BSP, qfalse));
+	memcpy(pf->treeNodes, nodes, num_nodes * sizeof(patchTreeNode_t));
+
+	Z_Free(nodes);
+	Z_Free(facet_bounds);
+
+	c_totalPatchTreeNodes += num_nodes;
+	c_totalPatchTreeBytes += static_cast<int>(num_nodes * sizeof(patchTreeNode_t) + pf->numFacets * sizeof(int));
+}
+
+/*
+==================
+CM_PatchTreeFacets
+
+Sets a bit in marks for each facet whose bounds touch the trace's, and returns
+qtrue. Returns qfalse if the patch has no tree, in which case every facet needs
+testing.
+==================
+*/
+static qboolean CM_PatchTreeFacets(const traceWork_t* tw, const patchCollide_t* pc, unsigned int* marks) {
+	int stack[64];
+	int depth = 0;
+
+#ifndef BSPC
+	if (!cm_patchTree->integer) {
+		return qfalse;
+	}
+#endif
+	if (!pc->numTreeNodes) {
+		return qfalse;
+	}
+
+	memset(marks, 0, ((pc->numFacets + 31) >> 5) * sizeof(*marks));
+
+	stack[depth++] = 0;
+	while (depth) {
+		const patchTreeNode_t* node = &pc->treeNodes[stack[--depth]];
+
+		if (tw->bounds[0][0] > node->bounds[1][0] || tw->bounds[1][0] < node->bounds[0][0]
+			|| tw->bounds[0][1] > node->bounds[1][1] || tw->bounds[1][1] < node->bounds[0][1]
+			|| tw->bounds[0][2] > node->bounds[1][2] || tw->bounds[1][2] < node->bounds[0][2]) {
+			continue;
+		}
+
+		if (node->numFacets) {
+			for (int i = node->firstFacet; i < node->firstFacet + node->numFacets; i++) {
+				const int facet_num = pc->treeFacets[i];
+				marks[facet_num >> 5] |= 1u << (facet_num & 31);
+			}
+		}
+		else {
+			// median splits keep it to about log2(MAX_FACETS) deep
+			assert(depth + 2 <= static_cast<int>(ARRAY_LEN(stack)));
+			stack[depth++] = node->children;
+			stack[depth++] = node->children + 1;
+		}
+	}
+	return qtrue;
+}
+
+// the first marked facet from facet_num on, or num_facets if there are no more
+static int CM_NextPatchFacet(const unsigned int* marks, int facet_num, const int num_facets) {
+	while (facet_num < num_facets) {
+		unsigned int word = marks[facet_num >> 5] >> (facet_num & 31);
+		if (!word) {
+			facet_num = (facet_num | 31) + 1;
+			continue;
+		}
+		while (!(word & 1)) {
+			word >>= 1;
+			facet_num++;
+		}
+		return facet_num;
+	}
+	return num_facets;
+}
+
 using edgeName_t = enum {
 	EN_TOP,
 	EN_RIGHT,
@@ -1148,6 +1351,9 @@ static void CM_PatchCollideFromGrid(cGrid_t* grid, patchCollide_t* pf) {
 	memcpy(pf->planes, planes, numplanes * sizeof(*pf->planes));
 
 	Z_Free(facets);
+
+	c_totalPatchFacets += num_facets;
+	CM_BuildPatchTree(pf);
 }
 
 static patchCollide_t* pfScratch = nullptr;
@@ -1353,6 +1559,29 @@ void CM_TraceThroughPatchCollide( traceWork_t *tw, const struct patchCollide_s *
 	} //end for
 } //end of the function CM_TraceThroughPatchCollide*/
 
+// how the trace crosses one plane, for CM_TracePointThroughPatchCollide
+static void CM_PatchPlaneIntersection(const traceWork_t* tw, const patchPlane_t* planes, qboolean* front_facing,
+	float* intersection) {
+	const float offset = DotProduct(tw->offsets[planes->signbits], planes->plane);
+	const float d1 = DotProduct(tw->start, planes->plane) - planes->plane[3] + offset;
+	const float d2 = DotProduct(tw->end, planes->plane) - planes->plane[3] + offset;
+	if (d1 <= 0) {
+		*front_facing = qfalse;
+	}
+	else {
+		*front_facing = qtrue;
+	}
+	if (d1 == d2) {
+		*intersection = WORLD_SIZE;
+	}
+	else {
+		*intersection = d1 / (d1 - d2);
+		if (*intersection <= 0) {
+			*intersection = WORLD_SIZE;
+		}
+	}
+}
+
 /*
 ====================
 CM_TracePointThroughPatchCollide
@@ -1361,8 +1590,9 @@ CM_TracePointThroughPatchCollide
 ====================
 */
 void CM_TracePointThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc) {
-	qboolean	front_facing[MAX_PATCH_PLANES]{};
-	float		intersection[MAX_PATCH_PLANES]{};
+	qboolean	front_facing[MAX_PATCH_PLANES];	// only the planes in use are filled in
+	float		intersection[MAX_PATCH_PLANES];
+	unsigned int	marks[MAX_FACETS / 32];
 	float		intersect;
 	const patchPlane_t* planes;
 	const facet_t* facet;
@@ -1383,32 +1613,24 @@ void CM_TracePointThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc)
 	{	//not gonna do anything anyhow?
 		return;
 	}
-	// determine the trace's relationship to all planes
-	planes = pc->planes;
-	for (i = 0; i < pc->numplanes; i++, planes++) {
-		offset = DotProduct(tw->offsets[planes->signbits], planes->plane);
-		d1 = DotProduct(tw->start, planes->plane) - planes->plane[3] + offset;
-		d2 = DotProduct(tw->end, planes->plane) - planes->plane[3] + offset;
-		if (d1 <= 0) {
-			front_facing[i] = qfalse;
-		}
-		else {
-			front_facing[i] = qtrue;
-		}
-		if (d1 == d2) {
-			intersection[i] = WORLD_SIZE;
-		}
-		else {
-			intersection[i] = d1 / (d1 - d2);
-			if (intersection[i] <= 0) {
-				intersection[i] = WORLD_SIZE;
-			}
+	// with a tree, only the facets near the trace and the planes they use are looked at,
+	// otherwise determine the trace's relationship to all planes
+	const qboolean use_tree = CM_PatchTreeFacets(tw, pc, marks);
+	if (!use_tree) {
+		planes = pc->planes;
+		for (i = 0; i < pc->numplanes; i++, planes++) {
+			CM_PatchPlaneIntersection(tw, planes, &front_facing[i], &intersection[i]);
 		}
 	}
 
 	// see if any of the surface planes are intersected
-	facet = pc->facets;
-	for (i = 0; i < pc->numFacets; i++, facet++) {
+	for (i = use_tree ? CM_NextPatchFacet(marks, 0, pc->numFacets) : 0; i < pc->numFacets;
+		i = use_tree ? CM_NextPatchFacet(marks, i + 1, pc->numFacets) : i + 1) {
+		facet = &pc->facets[i];
+		if (use_tree) {
+			k = facet->surfacePlane;
+			CM_PatchPlaneIntersection(tw, &pc->planes[k], &front_facing[k], &intersection[k]);
+		}
 		if (!front_facing[facet->surfacePlane]) {
 			continue;
 		}
@@ -1421,6 +1643,9 @@ void CM_TracePointThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc)
 		}
 		for (j = 0; j < facet->numBorders; j++) {
 			k = facet->borderPlanes[j];
+			if (use_tree) {
+				CM_PatchPlaneIntersection(tw, &pc->planes[k], &front_facing[k], &intersection[k]);
+			}
 			if (front_facing[k] ^ facet->borderInward[j]) {
 				if (intersection[k] > intersect) {
 					break;
@@ -1435,10 +1660,10 @@ void CM_TracePointThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc)
 		if (j == facet->numBorders) {
 			// we hit this facet
 #ifndef BSPC
-			if (!cv) {
+			if (!cm_traceWorker && !cv) {
 				cv = Cvar_Get("r_debugSurfaceUpdate", "1", 0);
 			}
-			if (cv->integer) {
+			if (!cm_traceWorker && cv && cv->integer) {
 				debugPatchCollide = pc;
 				debugFacet = facet;
 			}
@@ -1533,8 +1758,11 @@ void CM_TraceThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc)
 	return;
 #endif
 	//
-	facet = pc->facets;
-	for (int i = 0; i < pc->numFacets; i++, facet++) {
+	unsigned int marks[MAX_FACETS / 32];
+	const qboolean use_tree = CM_PatchTreeFacets(tw, pc, marks);
+	for (int i = use_tree ? CM_NextPatchFacet(marks, 0, pc->numFacets) : 0; i < pc->numFacets;
+		i = use_tree ? CM_NextPatchFacet(marks, i + 1, pc->numFacets) : i + 1) {
+		facet = &pc->facets[i];
 		vec3_t endp;
 		vec3_t startp;
 		enter_frac = -1.0;
@@ -1624,10 +1852,10 @@ void CM_TraceThroughPatchCollide(traceWork_t* tw, const patchCollide_s* pc)
 					enter_frac = 0;
 				}
 #ifndef BSPC
-				if (!cv) {
+				if (!cm_traceWorker && !cv) {
 					cv = Cvar_Get("r_debugSurfaceUpdate", "1", 0);
 				}
-				if (cv && cv->integer) {
+				if (!cm_traceWorker && cv && cv->integer) {
 					debugPatchCollide = pc;
 					debugFacet = facet;
 				}
@@ -1653,6 +1881,19 @@ constexpr auto BOX_FRONT = 0;
 constexpr auto BOX_BACK = 1;
 constexpr auto BOX_CROSS = 2;
 
+// which side of one plane the box is, for CM_PositionTestInPatchCollide
+static int CM_PatchPlaneCross(const traceWork_t* tw, const patchPlane_t* planes) {
+	const float d = DotProduct(tw->start, planes->plane) - planes->plane[3];
+	const float offset = fabs(DotProduct(tw->offsets[planes->signbits], planes->plane));
+	if (d < -offset) {
+		return BOX_FRONT;
+	}
+	if (d > offset) {
+		return BOX_BACK;
+	}
+	return BOX_CROSS;
+}
+
 /*
 ====================
 CM_PositionTestInPatchCollide
@@ -1661,12 +1902,11 @@ Modifies tr->tr if any of the facets effect the trace
 ====================
 */
 qboolean CM_PositionTestInPatchCollide(const traceWork_t* tw, const patchCollide_s* pc) {
-	int			cross[MAX_PATCH_PLANES]{};
+	int			cross[MAX_PATCH_PLANES];	// only the planes in use are filled in
+	unsigned int	marks[MAX_FACETS / 32];
 	const patchPlane_t* planes;
 	const facet_t* facet;
 	int			i, j, k;
-	float		offset;
-	float		d;
 
 	//return qfalse;
 
@@ -1679,25 +1919,23 @@ qboolean CM_PositionTestInPatchCollide(const traceWork_t* tw, const patchCollide
 	}
 #endif
 
-	// determine if the box is in front, behind, or crossing each plane
-	planes = pc->planes;
-	for (i = 0; i < pc->numplanes; i++, planes++) {
-		d = DotProduct(tw->start, planes->plane) - planes->plane[3];
-		offset = fabs(DotProduct(tw->offsets[planes->signbits], planes->plane));
-		if (d < -offset) {
-			cross[i] = BOX_FRONT;
-		}
-		else if (d > offset) {
-			cross[i] = BOX_BACK;
-		}
-		else {
-			cross[i] = BOX_CROSS;
+	// with a tree, only the facets near the box and the planes they use are looked at,
+	// otherwise determine if the box is in front, behind, or crossing each plane
+	const qboolean use_tree = CM_PatchTreeFacets(tw, pc, marks);
+	if (!use_tree) {
+		planes = pc->planes;
+		for (i = 0; i < pc->numplanes; i++, planes++) {
+			cross[i] = CM_PatchPlaneCross(tw, planes);
 		}
 	}
 
 	// see if any of the surface planes are intersected
-	facet = pc->facets;
-	for (i = 0; i < pc->numFacets; i++, facet++) {
+	for (i = use_tree ? CM_NextPatchFacet(marks, 0, pc->numFacets) : 0; i < pc->numFacets;
+		i = use_tree ? CM_NextPatchFacet(marks, i + 1, pc->numFacets) : i + 1) {
+		facet = &pc->facets[i];
+		if (use_tree) {
+			cross[facet->surfacePlane] = CM_PatchPlaneCross(tw, &pc->planes[facet->surfacePlane]);
+		}
 		// the facet plane must be in a cross state
 		if (cross[facet->surfacePlane] != BOX_CROSS) {
 			continue;
@@ -1705,6 +1943,9 @@ qboolean CM_PositionTestInPatchCollide(const traceWork_t* tw, const patchCollide
 		// all of the boundaries must be either cross or back
 		for (j = 0; j < facet->numBorders; j++) {
 			k = facet->borderPlanes[j];
+			if (use_tree) {
+				cross[k] = CM_PatchPlaneCross(tw, &pc->planes[k]);
+			}
 			if (cross[k] == BOX_CROSS) {
 				continue;
 			}
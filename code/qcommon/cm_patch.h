@@ -76,6 +76,19 @@ using facet_t = struct
 	qboolean borderNoAdjust[4 + 6 + 16];
 };
 
+// a bounding volume tree over a patch's facets, so a trace only visits the facets
+// near it rather than every one on a big arch or pipe
+constexpr auto PATCH_TREE_MIN_FACETS = 16; // fewer and a straight walk is just as quick
+constexpr auto PATCH_TREE_LEAF_FACETS = 4;
+
+using patchTreeNode_t = struct
+{
+	vec3_t bounds[2];
+	int children; // the first of two adjacent nodes, if numFacets is 0
+	int firstFacet; // into treeFacets
+	int numFacets;
+};
+
 using patchCollide_t = struct patchCollide_s
 {
 	vec3_t bounds[2];
@@ -83,6 +96,9 @@ using patchCollide_t = struct patchCollide_s
 	patchPlane_t* planes;
 	int numFacets;
 	facet_t* facets;
+	int numTreeNodes; // 0 if there's no tree
+	patchTreeNode_t* treeNodes; // [0] is the root
+	int* treeFacets; // facet numbers, grouped by leaf
 };
 
 constexpr auto CM_MAX_GRID_SIZE = 129;
@@ -54,6 +54,18 @@ void CM_TransformedBoxTrace(trace_t* results, const vec3_t start, const vec3_t e
 	clipHandle_t model, int brushmask,
 	const vec3_t origin, const vec3_t angles);
 
+using cmTraceRequest_t = struct
+{
+	vec3_t start, end;
+	vec3_t mins, maxs;
+	clipHandle_t model; // not CM_TempBoxModel, there's only the one box
+	int brushmask;
+};
+
+// same as calling CM_BoxTrace for each, spread over cm_traceThreads worker threads
+void CM_BoxTraceBatch(trace_t* results, const cmTraceRequest_t* requests, int num_requests);
+void CM_ShutdownTraceBatch();
+
 byte* CM_ClusterPVS(int cluster);
 
 int CM_PointLeafnum(const vec3_t p);
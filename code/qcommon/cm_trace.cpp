@@ -23,6 +23,64 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "cm_local.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if !defined(BSPC) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CM_SSE2_BRUSHES
+#include <emmintrin.h>
+#endif
+
+/*
+===============================================================================
+
+VISITED BRUSHES
+
+A brush or patch usually spans several leafs, so a trace remembers which ones it
+has already tested. That used to be a checkcount stamped into the shared cbrush_t
+and cPatch_t, which made every trace a write to the map, so here each thread keeps
+its own stamps per clip map instead, and bumps a generation per trace rather than
+clearing them.
+
+===============================================================================
+*/
+
+using traceVisited_t = struct traceVisited_s
+{
+	const clipMap_t* local;
+	unsigned int stamp;
+	std::vector<unsigned int> brushes; // [numBrushes + 1], the last is the temp box brush
+	std::vector<unsigned int> patches; // [numSurfaces]
+};
+
+static thread_local traceVisited_t cm_traceVisited[1 + MAX_SUB_BSP];
+
+// set on the CM_BoxTraceBatch worker threads, which leave the stat counters and debug hooks alone
+thread_local bool cm_traceWorker = false;
+
+static traceVisited_t* CM_BeginTrace(const clipMap_t* local)
+{
+	traceVisited_t* visited = &cm_traceVisited[local == &cmg ? 0 : 1 + (local - SubBSP)];
+
+	const size_t num_brushes = local->numBrushes + 1;
+	const size_t num_patches = local->numSurfaces;
+
+	visited->stamp++;
+	if (visited->local != local || visited->brushes.size() != num_brushes || visited->patches.size() != num_patches
+		|| !visited->stamp)
+	{
+		// another map, or the stamp wrapped
+		visited->local = local;
+		visited->brushes.assign(num_brushes, 0);
+		visited->patches.assign(num_patches, 0);
+		visited->stamp = 1;
+	}
+	return visited;
+}
+
 /*
 ===============================================================================
 
@@ -251,11 +309,11 @@ void CM_TestInLeaf(traceWork_t* tw, const cLeaf_t* leaf, const clipMap_t* local)
 	{
 		const int brushnum = local->leafbrushes[leaf->firstLeafBrush + k];
 		cbrush_t* b = &local->brushes[brushnum];
-		if (b->checkcount == local->checkcount)
+		if (tw->visited->brushes[brushnum] == tw->visited->stamp)
 		{
 			continue; // already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
+		tw->visited->brushes[brushnum] = tw->visited->stamp;
 
 		if (!(b->contents & tw->contents))
 		{
@@ -278,17 +336,18 @@ void CM_TestInLeaf(traceWork_t* tw, const cLeaf_t* leaf, const clipMap_t* local)
 #endif //BSPC
 		for (k = 0; k < leaf->numLeafSurfaces; k++)
 		{
-			cPatch_t* patch = local->surfaces[local->leafsurfaces[leaf->firstLeafSurface + k]];
+			const int surfacenum = local->leafsurfaces[leaf->firstLeafSurface + k];
+			cPatch_t* patch = local->surfaces[surfacenum];
 
 			if (!patch)
 			{
 				continue;
 			}
-			if (patch->checkcount == local->checkcount)
+			if (tw->visited->patches[surfacenum] == tw->visited->stamp)
 			{
 				continue; // already checked this brush in another leaf
 			}
-			patch->checkcount = local->checkcount;
+			tw->visited->patches[surfacenum] = tw->visited->stamp;
 
 			if (!(patch->contents & tw->contents))
 			{
@@ -336,12 +395,8 @@ void CM_PositionTest(traceWork_t * tw)
 	ll.lastLeaf = 0;
 	ll.overflowed = qfalse;
 
-	cmg.checkcount++;
-
 	CM_BoxLeafnums_r(&ll, 0);
 
-	cmg.checkcount++;
-
 	// test the contents of the leafs
 	for (i = 0; i < ll.count; i++)
 	{
@@ -369,7 +424,10 @@ CM_TraceThroughPatch
 
 void CM_TraceThroughPatch(traceWork_t * tw, const cPatch_t * patch)
 {
-	c_patch_traces++;
+	if (!cm_traceWorker)
+	{
+		c_patch_traces++;
+	}
 
 	const float old_frac = tw->trace.fraction;
 
@@ -382,12 +440,138 @@ void CM_TraceThroughPatch(traceWork_t * tw, const cPatch_t * patch)
 	}
 }
 
+#ifdef CM_SSE2_BRUSHES
+/*
+================
+CM_TraceThroughBrushSides
+
+The side loop of CM_TraceThroughBrush, four sides at a time out of the structure of
+arrays planes. d1 and d2 come out exactly as the scalar loop's (the same operations
+in the same order, just in lanes), and the sides that cross are still taken one at a
+time in order with the scalar code, so the results match it bit for bit.
+Returns false if the trace is completely in front of a side.
+================
+*/
+static bool CM_TraceThroughBrushSides(const traceWork_t* tw, const cbrush_t* brush, const clipMap_t* local,
+	float& enter_frac, float& leave_frac, const cplane_t*& clipplane, const cbrushside_t*& leadside,
+	qboolean& getout, qboolean& startout)
+{
+	const cbrushsidePlanes_t& planes = local->sidePlanes;
+	const int first_side = brush->sides - local->brushsides;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 epsilon = _mm_set1_ps(SURFACE_CLIP_EPSILON);
+	const __m128 size0[3] = { _mm_set1_ps(tw->size[0][0]), _mm_set1_ps(tw->size[0][1]), _mm_set1_ps(tw->size[0][2]) };
+	const __m128 size1[3] = { _mm_set1_ps(tw->size[1][0]), _mm_set1_ps(tw->size[1][1]), _mm_set1_ps(tw->size[1][2]) };
+	const __m128 start[3] = { _mm_set1_ps(tw->start[0]), _mm_set1_ps(tw->start[1]), _mm_set1_ps(tw->start[2]) };
+	const __m128 end[3] = { _mm_set1_ps(tw->end[0]), _mm_set1_ps(tw->end[1]), _mm_set1_ps(tw->end[2]) };
+
+	for (int i = 0; i < brush->numsides; i += 4)
+	{
+		const int n = first_side + i;
+		const int lanes = (1 << Q_min(4, brush->numsides - i)) - 1;
+		__m128 normal[3], offset[3];
+
+		for (int j = 0; j < 3; j++)
+		{
+			// tw->offsets[signbits] is size[1] on the axes the normal points negative on
+			const __m128 sign = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes.signMask[j] + n)));
+			normal[j] = _mm_loadu_ps(planes.normal[j] + n);
+			offset[j] = _mm_or_ps(_mm_and_ps(sign, size1[j]), _mm_andnot_ps(sign, size0[j]));
+		}
+
+		// dist = plane->dist - DotProduct(offset, normal), d = DotProduct(point, normal) - dist
+		const __m128 dist = _mm_sub_ps(_mm_loadu_ps(planes.dist + n),
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(offset[0], normal[0]), _mm_mul_ps(offset[1], normal[1])),
+				_mm_mul_ps(offset[2], normal[2])));
+		const __m128 d1 = _mm_sub_ps(
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(start[0], normal[0]), _mm_mul_ps(start[1], normal[1])),
+				_mm_mul_ps(start[2], normal[2])), dist);
+		const __m128 d2 = _mm_sub_ps(
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(end[0], normal[0]), _mm_mul_ps(end[1], normal[1])),
+				_mm_mul_ps(end[2], normal[2])), dist);
+
+		const int end_out = _mm_movemask_ps(_mm_cmpgt_ps(d2, zero)) & lanes;
+		const int start_out = _mm_movemask_ps(_mm_cmpgt_ps(d1, zero)) & lanes;
+
+		// if completely in front of any face, no intersection with the entire brush
+		if (start_out & _mm_movemask_ps(_mm_or_ps(_mm_cmpge_ps(d2, epsilon), _mm_cmpge_ps(d2, d1))))
+		{
+			return false;
+		}
+
+		if (end_out)
+		{
+			getout = qtrue; // endpoint is not in solid
+		}
+		if (start_out)
+		{
+			startout = qtrue;
+		}
+
+		// the ones that don't cross the plane aren't relevent
+		int crossing = (start_out | end_out);
+		if (!crossing)
+		{
+			continue;
+		}
+
+		float d1s[4], d2s[4];
+		_mm_storeu_ps(d1s, d1);
+		_mm_storeu_ps(d2s, d2);
+
+		for (int j = 0; crossing; j++, crossing >>= 1)
+		{
+			if (!(crossing & 1))
+			{
+				continue;
+			}
+
+			const cbrushside_t* side = brush->sides + i + j;
+			float f;
+
+			// crosses face
+			if (d1s[j] > d2s[j])
+			{
+				// enter
+				f = (d1s[j] - SURFACE_CLIP_EPSILON) / (d1s[j] - d2s[j]);
+				if (f < 0)
+				{
+					f = 0;
+				}
+				if (f > enter_frac)
+				{
+					enter_frac = f;
+					clipplane = side->plane;
+					leadside = side;
+				}
+			}
+			else
+			{
+				// leave
+				f = (d1s[j] + SURFACE_CLIP_EPSILON) / (d1s[j] - d2s[j]);
+				if (f > 1)
+				{
+					f = 1;
+				}
+				if (f < leave_frac)
+				{
+					leave_frac = f;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+#endif
+
 /*
 ================
 CM_TraceThroughBrush
 ================
 */
-void CM_TraceThroughBrush(traceWork_t * tw, const cbrush_t * brush)
+void CM_TraceThroughBrush(traceWork_t * tw, const cbrush_t * brush, const clipMap_t * local)
 {
 	float f;
 
@@ -413,7 +597,10 @@ void CM_TraceThroughBrush(traceWork_t * tw, const cbrush_t * brush)
 		return;
 	}
 
-	c_brush_traces++;
+	if (!cm_traceWorker)
+	{
+		c_brush_traces++;
+	}
 
 	qboolean getout = qfalse;
 	qboolean startout = qfalse;
@@ -425,6 +612,16 @@ void CM_TraceThroughBrush(traceWork_t * tw, const cbrush_t * brush)
 	// find the latest time the trace crosses a plane towards the interior
 	// and the earliest time the trace crosses a plane towards the exterior
 	//
+#ifdef CM_SSE2_BRUSHES
+	if (cm_simdBrushes->integer && local->sidePlanes.dist)
+	{
+		if (!CM_TraceThroughBrushSides(tw, brush, local, enter_frac, leave_frac, clipplane, leadside, getout, startout))
+		{
+			return;
+		}
+	}
+	else
+#endif
 	for (int i = 0; i < brush->numsides; i++)
 	{
 		const cbrushside_t* side = brush->sides + i;
@@ -560,11 +757,11 @@ void CM_TraceToLeaf(traceWork_t * tw, const cLeaf_t * leaf, const clipMap_t * lo
 		const int brushnum = local->leafbrushes[leaf->firstLeafBrush + k];
 
 		cbrush_t* b = &local->brushes[brushnum];
-		if (b->checkcount == local->checkcount)
+		if (tw->visited->brushes[brushnum] == tw->visited->stamp)
 		{
 			continue; // already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
+		tw->visited->brushes[brushnum] = tw->visited->stamp;
 
 		if (!(b->contents & tw->contents))
 		{
@@ -573,7 +770,7 @@ void CM_TraceToLeaf(traceWork_t * tw, const cLeaf_t * leaf, const clipMap_t * lo
 
 		//if (b->contents & CONTENTS_PLAYERCLIP) continue;
 
-		CM_TraceThroughBrush(tw, b);
+		CM_TraceThroughBrush(tw, b, local);
 		if (!tw->trace.fraction)
 		{
 			return;
@@ -589,16 +786,17 @@ void CM_TraceToLeaf(traceWork_t * tw, const cLeaf_t * leaf, const clipMap_t * lo
 #endif
 		for (k = 0; k < leaf->numLeafSurfaces; k++)
 		{
-			cPatch_t* patch = local->surfaces[local->leafsurfaces[leaf->firstLeafSurface + k]];
+			const int surfacenum = local->leafsurfaces[leaf->firstLeafSurface + k];
+			cPatch_t* patch = local->surfaces[surfacenum];
 			if (!patch)
 			{
 				continue;
 			}
-			if (patch->checkcount == local->checkcount)
+			if (tw->visited->patches[surfacenum] == tw->visited->stamp)
 			{
 				continue; // already checked this patch in another leaf
 			}
-			patch->checkcount = local->checkcount;
+			tw->visited->patches[surfacenum] = tw->visited->stamp;
 
 			if (!(patch->contents & tw->contents))
 			{
@@ -802,13 +1000,15 @@ void CM_BoxTrace(trace_t * results, const vec3_t start, const vec3_t end,
 
 	const cmodel_t* cmod = CM_ClipHandleToModel(model, &local);
 
-	local->checkcount++; // for multi-check avoidance
-
-	c_traces++; // for statistics, may be zeroed
+	if (!cm_traceWorker)
+	{
+		c_traces++; // for statistics, may be zeroed
+	}
 
 	// fill in a default trace
 	memset(&tw, 0, sizeof tw - sizeof tw.trace.G2CollisionMap);
 	tw.trace.fraction = 1; // assume it goes the entire distance until shown otherwise
+	tw.visited = CM_BeginTrace(local); // for multi-check avoidance
 
 	if (!local->numNodes)
 	{
@@ -1049,6 +1249,150 @@ void CM_TransformedBoxTrace(trace_t * results, const vec3_t start, const vec3_t
 	*results = trace;
 }
 
+/*
+===============================================================================
+
+TRACE BATCHES
+
+A small pool of workers for CM_BoxTraceBatch, started on the first batch after each
+map load. The caller takes a share of every batch too, and only returns once all of
+it is done, so the workers never touch the map while it's being changed.
+
+===============================================================================
+*/
+
+constexpr int MAX_TRACE_THREADS = 8;
+constexpr int MIN_TRACE_BATCH = 16; // smaller batches aren't worth waking anybody for
+
+static std::mutex cm_batchCallMutex; // one batch at a time
+static std::mutex cm_batchMutex; // guards everything below but cm_batchNext
+static std::condition_variable cm_batchWake;
+static std::condition_variable cm_batchDone;
+static std::vector<std::thread> cm_batchWorkers;
+static bool cm_batchQuit;
+static unsigned int cm_batchGeneration; // bumped per batch, so a worker can tell a new one from a spurious wakeup
+static int cm_batchBusy; // workers still on the current batch
+static trace_t* cm_batchResults;
+static const cmTraceRequest_t* cm_batchRequests;
+static int cm_batchCount;
+static std::atomic<int> cm_batchNext;
+
+// returns how many of the batch's traces this thread did
+static int CM_RunTraceBatch()
+{
+	int done = 0;
+
+	for (int i = cm_batchNext++; i < cm_batchCount; i = cm_batchNext++)
+	{
+		const cmTraceRequest_t& request = cm_batchRequests[i];
+		CM_BoxTrace(&cm_batchResults[i], request.start, request.end, request.mins, request.maxs, request.model,
+			request.brushmask);
+		done++;
+	}
+	return done;
+}
+
+static void CM_TraceBatchWorker(unsigned int generation)
+{
+	cm_traceWorker = true;
+
+	std::unique_lock<std::mutex> lock(cm_batchMutex);
+	while (true)
+	{
+		cm_batchWake.wait(lock, [generation] { return cm_batchQuit || cm_batchGeneration != generation; });
+		if (cm_batchQuit)
+		{
+			return;
+		}
+		generation = cm_batchGeneration;
+
+		lock.unlock();
+		CM_RunTraceBatch();
+		lock.lock();
+
+		if (!--cm_batchBusy)
+		{
+			cm_batchDone.notify_one();
+		}
+	}
+}
+
+/*
+==================
+CM_BoxTraceBatch
+
+Same results as calling CM_BoxTrace on each request in turn. Requests can't use
+CM_TempBoxModel, since there's only the one box to go round.
+==================
+*/
+void CM_BoxTraceBatch(trace_t* results, const cmTraceRequest_t* requests, const int num_requests)
+{
+	int i;
+
+	const int num_threads = cm_traceThreads ? Com_Clampi(0, MAX_TRACE_THREADS, cm_traceThreads->integer) : 0;
+
+	if (!num_threads || num_requests < MIN_TRACE_BATCH || cm_traceWorker)
+	{
+		for (i = 0; i < num_requests; i++)
+		{
+			CM_BoxTrace(&results[i], requests[i].start, requests[i].end, requests[i].mins, requests[i].maxs,
+				requests[i].model, requests[i].brushmask);
+		}
+		return;
+	}
+
+	// bad handles are a Com_Error, which has to happen out here rather than on a worker
+	for (i = 0; i < num_requests; i++)
+	{
+		CM_ClipHandleToModel(requests[i].model);
+	}
+
+	std::lock_guard<std::mutex> call_lock(cm_batchCallMutex);
+	std::unique_lock<std::mutex> lock(cm_batchMutex);
+
+	while (static_cast<int>(cm_batchWorkers.size()) < num_threads)
+	{
+		cm_batchWorkers.emplace_back(CM_TraceBatchWorker, cm_batchGeneration);
+	}
+
+	cm_batchResults = results;
+	cm_batchRequests = requests;
+	cm_batchCount = num_requests;
+	cm_batchNext = 0;
+	cm_batchBusy = static_cast<int>(cm_batchWorkers.size());
+	cm_batchGeneration++;
+
+	lock.unlock();
+	cm_batchWake.notify_all();
+	const int done = CM_RunTraceBatch();
+	lock.lock();
+
+	cm_batchDone.wait(lock, [] { return !cm_batchBusy; });
+	cm_batchResults = nullptr;
+	cm_batchRequests = nullptr;
+	cm_batchCount = 0;
+
+	c_traces += num_requests - done; // the workers' share
+}
+
+void CM_ShutdownTraceBatch()
+{
+	std::lock_guard<std::mutex> call_lock(cm_batchCallMutex);
+
+	{
+		std::lock_guard<std::mutex> lock(cm_batchMutex);
+		cm_batchQuit = true;
+	}
+	cm_batchWake.notify_all();
+
+	for (std::thread& worker : cm_batchWorkers)
+	{
+		worker.join();
+	}
+	cm_batchWorkers.clear();
+	cm_batchQuit = false;
+}
+
 /*
 =================
 CM_CullBox
@@ -1104,4 +1448,4 @@ bool CM_CullWorldBox(const cplane_t * frustum, const vec3pair_t bounds)
 
 	//rwwFIXMEFIXME: Was not ! before. But that seems the way it should be and it works that way. Why?
 	return !CM_CullBox(frustum, transformed);
-}
\ No newline at end of file
+}
@@ -1571,6 +1571,14 @@ void Com_Frame()
 				com_frameNumber, all, sv, ev, cl, time_game, timeInTrace, timeInPVSCheck, time_frontend,
 				time_backend);
 
+			extern int sv_traceCacheHits, sv_traceCacheMisses;
+			if (sv_traceCacheHits || sv_traceCacheMisses)
+			{
+				Com_Printf("trace cache: %i hits, %i misses (%.0f%%)\n", sv_traceCacheHits, sv_traceCacheMisses,
+					100.0f * sv_traceCacheHits / (sv_traceCacheHits + sv_traceCacheMisses));
+				sv_traceCacheHits = sv_traceCacheMisses = 0;
+			}
+
 			// speedslog
 			if (com_speedslog && com_speedslog->integer)
 			{
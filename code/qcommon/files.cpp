@@ -36,6 +36,15 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../client/client.h"
 #endif
 #include <minizip/unzip.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
  // for rmdir
 #if defined (_MSC_VER)
@@ -202,6 +211,14 @@ typedef struct fileInPack_s {
 	fileInPack_s* next;		// next file in the hash
 } fileInPack_t;
 
+// a whole pk3 mapped into memory, shared by the pak and every buffer FS_MapFile has
+// handed out of it, so it outlives FS_FreePak until the last of those is freed
+typedef struct pakMapping_s {
+	byte* base;
+	size_t			size;
+	int				refs;
+} pakMapping_t;
+
 typedef struct pack_s {
 	char			pakPathname[MAX_OSPATH];	// c:\jediacademy\gamedata\base
 	char			pakFilename[MAX_OSPATH];	// c:\jediacademy\gamedata\base\assets0.pk3
@@ -213,6 +230,8 @@ typedef struct pack_s {
 	int				hashSize;					// hash table size (power of 2)
 	fileInPack_t** hashTable;					// hash table
 	fileInPack_t* buildBuffer;				// buffer with the filenames etc.
+	pakMapping_t* mapping;					// NULL until FS_MapFile first needs it
+	qboolean		mapFailed;					// don't keep retrying Sys_MapFile
 } pack_t;
 
 typedef struct directory_s {
@@ -228,6 +247,13 @@ typedef struct searchpath_s {
 	directory_t* dir;
 } searchpath_t;
 
+// one entry per distinct file across every pak in the search path, pointing at the pak that wins it
+typedef struct fileIndexEntry_s {
+	const fileInPack_t* pakFile;
+	const searchpath_t* search;		// the pak's element in fs_searchpaths
+	fileIndexEntry_s* next;		// next entry in the hash
+} fileIndexEntry_t;
+
 static char		fs_gamedir[MAX_OSPATH];	// this will be a single file name with no separators
 static cvar_t* fs_debug;
 static cvar_t* fs_homepath;
@@ -248,6 +274,26 @@ static int			fs_readCount;			// total bytes read
 static int			fs_loadCount;			// total files read
 static int			fs_packFiles = 0;		// total number of files in packs
 
+static fileIndexEntry_t** fs_fileIndex;		// built by FS_BuildFileIndex, NULL until then
+static int			fs_fileIndexSize;		// hash table size (power of 2)
+static int			fs_fileIndexCount;		// distinct files in it
+
+// remembers recent FS_FOpenFileRead misses, so repeated probes for files that aren't
+// there (.wav before .mp3, .png/.tga/.jpg etc) don't go all the way down the search path
+// and out to the OS again every time
+#define NEGCACHE_SIZE		2048	// power of 2, direct-mapped
+typedef struct negCacheEntry_s {
+	char		name[MAX_QPATH];	// empty slot if name[0] == 0
+} negCacheEntry_t;
+
+static negCacheEntry_t	fs_negCache[NEGCACHE_SIZE];
+static cvar_t* fs_negativeCache;
+static int			fs_negCacheHits;
+static int			fs_negCacheMisses;
+static int			fs_negCacheStores;
+static int			fs_negCacheEvictions;
+static int			fs_negCacheFlushes;
+
 typedef union qfile_gus {
 	FILE* o;
 	unzFile		z;
@@ -265,11 +311,105 @@ typedef struct fileHandleData_s {
 	int			zipFilePos;
 	int			zipFileLen;
 	qboolean	zipFile;
+	pack_t* zipPak;		// pak the zip handle reads from
 	char		name[MAX_ZPATH];
 } fileHandleData_t;
 
 static fileHandleData_t	fsh[MAX_FILE_HANDLES];
 
+// buffers FS_MapFile returned that point into a pak mapping rather than the zone,
+// so FS_FreeFile knows which is which
+#define MAX_MAPPED_FILES	64
+typedef struct mappedFile_s {
+	const void* data;		// NULL if slot free
+	pakMapping_t* mapping;
+} mappedFile_t;
+
+static mappedFile_t	fs_mappedFiles[MAX_MAPPED_FILES];
+static int			fs_mappedFileCount;
+static cvar_t* fs_mmap;
+
+// background readahead: worker threads read and inflate queued pk3 entries straight into
+// the zone buffers FS_ReadFile will hand out, allocated up front on the main thread since the
+// zone isn't thread safe (the workers' own minizip handles use malloc for the same reason).
+// Everything in here except the worker list is guarded by fs_prefetchMutex
+#define MAX_PREFETCH_FILES	1024
+typedef enum {
+	PREFETCH_FREE,
+	PREFETCH_QUEUED,
+	PREFETCH_READING,
+	PREFETCH_READY,
+	PREFETCH_FAILED
+} prefetchState_t;
+
+typedef struct prefetchEntry_s {
+	prefetchState_t	state;
+	long			hash;						// FS_HashFullFileName of name, to skip most compares
+	char			name[MAX_QPATH];
+	char			pakFilename[MAX_OSPATH];	// copied, so the job doesn't care if the pak goes away
+	unsigned long	pos;						// file info position in zip
+	unsigned long	dataPos;					// where its data starts in the pk3, to sort the reads by
+	long			len;
+	byte* data;						// TAG_FILESYS, len + 1 with the trailing 0, filled in by the worker
+} prefetchEntry_t;
+
+static prefetchEntry_t		fs_prefetchEntries[MAX_PREFETCH_FILES];
+static int					fs_prefetchCount;		// entries not FREE
+static long					fs_prefetchBytes;		// reserved by entries not FREE
+static std::deque<int>		fs_prefetchQueue;		// QUEUED entries, oldest first
+static bool					fs_prefetchQuit;
+static std::mutex			fs_prefetchMutex;
+static std::condition_variable	fs_prefetchWake;	// something queued, or quit
+static std::condition_variable	fs_prefetchDone;	// something stopped READING
+static std::vector<std::thread>	fs_prefetchWorkers;	// main thread only
+static cvar_t* fs_prefetch;
+static cvar_t* fs_prefetchThreads;
+static cvar_t* fs_prefetchMB;
+
+// every file opened during the current level load (FS_LevelLoadBegin to FS_LevelLoadEnd),
+// written out as the manifest the next load of the same map prefetches from
+#define LEVELFILE_OPENED	1	// went through FS_FOpenFileRead
+#define LEVELFILE_READ		2	// ...and was read whole by FS_ReadFile, so worth prefetching
+typedef struct levelFile_s {
+	std::string		name;
+	int				flags;
+} levelFile_t;
+
+static char					fs_levelName[MAX_QPATH];
+static qboolean				fs_levelLoading;		// between FS_LevelLoadBegin and End
+static qboolean				fs_levelRecording;		// ...and not opening things on our own behalf
+static std::vector<levelFile_t>					fs_levelFiles;
+static std::unordered_map<std::string, size_t>	fs_levelFilesSeen;	// index into fs_levelFiles
+static std::chrono::steady_clock::time_point	fs_levelStart;
+static std::chrono::steady_clock::duration		fs_levelIOTime;		// main thread time inside the filesystem
+static long					fs_levelIOBytes;
+
+// adds the time spent in its scope to fs_levelIOTime during a level load. Only the
+// outermost one counts, so FS_ReadFile -> FS_FOpenFileRead etc isn't counted twice
+static int					fs_levelIODepth;
+struct levelIOTimer_t {
+	bool counting;
+	std::chrono::steady_clock::time_point start;
+
+	levelIOTimer_t() : counting(fs_levelLoading && fs_levelIODepth == 0) {
+		if (counting) {
+			fs_levelIODepth++;
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~levelIOTimer_t() {
+		if (counting) {
+			fs_levelIOTime += std::chrono::steady_clock::now() - start;
+			fs_levelIODepth--;
+		}
+	}
+};
+
+static void FS_LevelLoadRecord(const char* filename, int flags);
+
+static void FS_PrefetchDiscard(const char* filename);
+
 // last valid game folder used
 char lastValidBase[MAX_OSPATH];
 char lastValidGame[MAX_OSPATH];
@@ -320,6 +460,148 @@ static long FS_HashFileName(const char* fname, const int hashSize) {
 	return hash;
 }
 
+/*
+================
+return a hash value for the whole filename, extension included,
+normalised the same way as FS_FilenameCompare
+================
+*/
+static long FS_HashFullFileName(const char* fname, const int hashSize) {
+	long hash = 0;
+	int i = 0;
+	while (fname[i] != '\0') {
+		char letter = tolower(fname[i]);
+		if (letter == '\\' || letter == ':') letter = '/';
+		hash += static_cast<long>(letter) * (i + 119);
+		i++;
+	}
+	hash = (hash ^ (hash >> 10) ^ (hash >> 20));
+	hash &= (hashSize - 1);
+	return hash;
+}
+
+/*
+================
+FS_NegCacheFlush
+================
+*/
+static void FS_NegCacheFlush() {
+	Com_Memset(fs_negCache, 0, sizeof(fs_negCache));
+	fs_negCacheFlushes++;
+}
+
+/*
+================
+FS_NegCacheSameName
+
+Like FS_FilenameCompare, but case counts. Pak lookups ignore case, directory lookups
+don't on most filesystems, so a miss for one spelling says nothing about another
+================
+*/
+static qboolean FS_NegCacheSameName(const char* s1, const char* s2) {
+	int		c1;
+
+	do {
+		c1 = *s1++;
+		int c2 = *s2++;
+
+		if (c1 == '\\' || c1 == ':') {
+			c1 = '/';
+		}
+		if (c2 == '\\' || c2 == ':') {
+			c2 = '/';
+		}
+
+		if (c1 != c2) {
+			return qfalse;
+		}
+	} while (c1);
+
+	return qtrue;
+}
+
+/*
+================
+FS_NegCacheCheck
+
+qtrue if filename, spelt exactly like this, is known not to exist anywhere on the search path
+================
+*/
+static qboolean FS_NegCacheCheck(const char* filename) {
+	if (!fs_negativeCache || !fs_negativeCache->integer) {
+		return qfalse;
+	}
+
+	const negCacheEntry_t* entry = &fs_negCache[FS_HashFullFileName(filename, NEGCACHE_SIZE)];
+	if (entry->name[0] && FS_NegCacheSameName(entry->name, filename)) {
+		fs_negCacheHits++;
+		return qtrue;
+	}
+	fs_negCacheMisses++;
+	return qfalse;
+}
+
+/*
+================
+FS_NegCacheStore
+================
+*/
+static void FS_NegCacheStore(const char* filename) {
+	if (!fs_negativeCache || !fs_negativeCache->integer || strlen(filename) >= MAX_QPATH) {
+		return;
+	}
+
+	negCacheEntry_t* entry = &fs_negCache[FS_HashFullFileName(filename, NEGCACHE_SIZE)];
+	if (entry->name[0]) {
+		fs_negCacheEvictions++;
+	}
+	Q_strncpyz(entry->name, filename, sizeof(entry->name));
+	fs_negCacheStores++;
+}
+
+/*
+================
+FS_NegCacheForget
+
+Called when something may have just created filename. Any spelling of it goes, since
+on a case insensitive filesystem they're all the same file
+================
+*/
+static void FS_NegCacheForget(const char* filename) {
+	negCacheEntry_t* entry = &fs_negCache[FS_HashFullFileName(filename, NEGCACHE_SIZE)];
+	if (entry->name[0] && !FS_FilenameCompare(entry->name, filename)) {
+		entry->name[0] = '\0';
+	}
+
+	// and a prefetched copy of the old one would be just as wrong
+	FS_PrefetchDiscard(filename);
+}
+
+/*
+================
+FS_NegCache_f
+================
+*/
+static void FS_NegCache_f() {
+	if (Cmd_Argc() == 2 && !Q_stricmp(Cmd_Argv(1), "flush")) {
+		FS_NegCacheFlush();
+		return;
+	}
+
+	int used = 0;
+	for (const negCacheEntry_t& entry : fs_negCache) {
+		if (entry.name[0]) {
+			used++;
+		}
+	}
+
+	const int lookups = fs_negCacheHits + fs_negCacheMisses;
+	Com_Printf("negative lookup cache: %s, %d/%d slots used\n", fs_negativeCache->integer ? "on" : "off", used, NEGCACHE_SIZE);
+	Com_Printf("%d lookups, %d hits (%.1f%%), %d misses\n", lookups, fs_negCacheHits,
+		lookups ? 100.0f * fs_negCacheHits / lookups : 0.0f, fs_negCacheMisses);
+	Com_Printf("%d stored, %d evicted, %d flushes\n", fs_negCacheStores, fs_negCacheEvictions, fs_negCacheFlushes);
+}
+
 static fileHandle_t FS_HandleForFile() {
 	int		i;
 
@@ -637,6 +919,8 @@ qboolean FS_MoveUserGenFile(const char* filename_src, const char* filename_dst)
 		Com_Printf("FS_MoveUserGenFile: %s --> %s\n", from_ospath, to_ospath);
 	}
 
+	FS_NegCacheForget(filename_dst);
+
 	FS_CheckFilenameIsMutable(to_ospath, __func__);
 
 	remove(to_ospath);
@@ -762,6 +1046,9 @@ fileHandle_t FS_SV_FOpenFileWrite(const char* filename) {
 		Com_Printf("FS_SV_FOpenFileWrite: %s\n", ospath);
 	}
 
+	// not relative to the game dirs, so don't try to work out which qpath this is
+	FS_NegCacheFlush();
+
 	FS_CheckFilenameIsMutable(ospath, __func__);
 
 	if (FS_CreatePath(ospath)) {
@@ -881,6 +1168,8 @@ void FS_SV_Rename(const char* from, const char* to, const qboolean safe) {
 		Com_Printf("FS_SV_Rename: %s --> %s\n", from_ospath, to_ospath);
 	}
 
+	FS_NegCacheFlush();
+
 	if (safe) {
 		FS_CheckFilenameIsMutable(to_ospath, __func__);
 	}
@@ -911,6 +1200,8 @@ void FS_Rename(const char* from, const char* to) {
 		Com_Printf("FS_Rename: %s --> %s\n", from_ospath, to_ospath);
 	}
 
+	FS_NegCacheForget(to);
+
 	FS_CheckFilenameIsMutable(to_ospath, __func__);
 
 	if (rename(from_ospath, to_ospath)) {
@@ -976,6 +1267,8 @@ fileHandle_t FS_FOpenFileWrite(const char* filename, const qboolean safe) {
 		Com_Printf("FS_FOpenFileWrite: %s\n", ospath);
 	}
 
+	FS_NegCacheForget(filename);
+
 	if (safe) {
 		FS_CheckFilenameIsMutable(ospath, __func__);
 	}
@@ -1021,6 +1314,8 @@ fileHandle_t FS_FOpenFileAppend(const char* filename) {
 		Com_Printf("FS_FOpenFileAppend: %s\n", ospath);
 	}
 
+	FS_NegCacheForget(filename);
+
 	FS_CheckFilenameIsMutable(ospath, __func__);
 
 	if (FS_CreatePath(ospath)) {
@@ -1190,6 +1485,51 @@ static bool FS_FileCacheable(const char* const filename)
 	return(strchr(filename, '/') != nullptr);
 }
 
+/*
+===========
+FS_FileIndexLookup
+
+Returns the pak entry that wins filename across the whole search path, or NULL
+if no pak has it (or the index hasn't been built yet)
+===========
+*/
+static const fileIndexEntry_t* FS_FileIndexLookup(const char* filename) {
+	if (!fs_fileIndex) {
+		return nullptr;
+	}
+
+	for (const fileIndexEntry_t* entry = fs_fileIndex[FS_HashFullFileName(filename, fs_fileIndexSize)]; entry; entry = entry->next) {
+		// case and separator insensitive comparisons
+		if (!FS_FilenameCompare(entry->pakFile->name, filename)) {
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+/*
+===========
+FS_FindFileInPack
+
+Looks for filename in the pak at this search path element. With the global
+index built, that's just a check of whether this pak is the one that won it.
+===========
+*/
+static const fileInPack_t* FS_FindFileInPack(const searchpath_t* search, const char* filename, const fileIndexEntry_t* indexed) {
+	if (fs_fileIndex) {
+		return (indexed && indexed->search == search) ? indexed->pakFile : nullptr;
+	}
+
+	const pack_t* pak = search->pack;
+	for (const fileInPack_t* pakFile = pak->hashTable[FS_HashFileName(filename, pak->hashSize)]; pakFile; pakFile = pakFile->next) {
+		// case and separator insensitive comparisons
+		if (!FS_FilenameCompare(pakFile->name, filename)) {
+			return pakFile;
+		}
+	}
+	return nullptr;
+}
+
 /*
 ===========
 FS_FOpenFileRead
@@ -1202,9 +1542,7 @@ separate file or a ZIP file.
 */
 extern qboolean		com_fullyInitialized;
 
-long FS_FOpenFileRead(const char* filename, fileHandle_t* file, const qboolean uniqueFILE) {
-	long hash = 0;
-
+static long FS_FOpenFileRead_Actual(const char* filename, fileHandle_t* file, const qboolean uniqueFILE) {
 	FS_AssertInitialised();
 
 	if (file == nullptr) {
@@ -1235,8 +1573,15 @@ long FS_FOpenFileRead(const char* filename, fileHandle_t* file, const qboolean u
 		return -1;
 	}
 
+	if (FS_NegCacheCheck(filename)) {
+		*file = 0;
+		return -1;
+	}
+
 	const bool isUserConfig = !Q_stricmp(filename, "autoexec_sp.cfg") || !Q_stricmp(filename, Q3CONFIG_NAME);
 
+	const fileIndexEntry_t* indexed = FS_FileIndexLookup(filename);
+
 	//
 	// search through the path, one element at a time
 	//
@@ -1256,68 +1601,60 @@ long FS_FOpenFileRead(const char* filename, fileHandle_t* file, const qboolean u
 		b_faster_to_re_open_using_new_local_file = qfalse;
 
 		for (const searchpath_t* search = fs_searchpaths; search; search = search->next) {
-			//
-			if (search->pack) {
-				hash = FS_HashFileName(filename, search->pack->hashSize);
-			}
 			// is the element a pak file?
-			if (search->pack && search->pack->hashTable[hash]) {
+			if (search->pack) {
 				// autoexec_sp.cfg and openjk_sp.cfg can only be loaded outside of pk3 files.
 				if (isUserConfig) {
 					continue;
 				}
 
-				// look through all the pak file elements
-				pack_t* pak = search->pack;
-				fileInPack_t* pakFile = pak->hashTable[hash];
-				do {
-					// case and separator insensitive comparisons
-					if (!FS_FilenameCompare(pakFile->name, filename)) {
-						// found it!
+				const fileInPack_t* pakFile = FS_FindFileInPack(search, filename, indexed);
+				if (pakFile) {
+					// found it!
+					pack_t* pak = search->pack;
 
-						if (uniqueFILE) {
-							// open a new file on the pakfile
-							fsh[*file].handleFiles.file.z = unzOpen(pak->pakFilename);
-							if (fsh[*file].handleFiles.file.z == nullptr) {
-								Com_Error(ERR_FATAL, "Couldn't open %s", pak->pakFilename);
-							}
-						}
-						else {
-							fsh[*file].handleFiles.file.z = pak->handle;
+					if (uniqueFILE) {
+						// open a new file on the pakfile
+						fsh[*file].handleFiles.file.z = unzOpen(pak->pakFilename);
+						if (fsh[*file].handleFiles.file.z == nullptr) {
+							Com_Error(ERR_FATAL, "Couldn't open %s", pak->pakFilename);
 						}
-						Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
-						fsh[*file].zipFile = qtrue;
+					}
+					else {
+						fsh[*file].handleFiles.file.z = pak->handle;
+					}
+					Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
+					fsh[*file].zipFile = qtrue;
+					fsh[*file].zipPak = pak;
 
-						// set the file position in the zip file (also sets the current file info)
-						unzSetOffset(fsh[*file].handleFiles.file.z, pakFile->pos);
+					// set the file position in the zip file (also sets the current file info)
+					unzSetOffset(fsh[*file].handleFiles.file.z, pakFile->pos);
 
-						// open the file in the zip
-						unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
+					// open the file in the zip
+					unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
 
 #if 0
-						zfi = (unz_s*)fsh[*file].handleFiles.file.z;
-						// in case the file was new
-						temp = zfi->filestream;
-						// set the file position in the zip file (also sets the current file info)
-						unzSetOffset(pak->handle, pakFile->pos);
-						// copy the file info into the unzip structure
-						Com_Memcpy(zfi, pak->handle, sizeof(unz_s));
-						// we copy this back into the structure
-						zfi->filestream = temp;
-						// open the file in the zip
-						unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
+					zfi = (unz_s*)fsh[*file].handleFiles.file.z;
+					// in case the file was new
+					temp = zfi->filestream;
+					// set the file position in the zip file (also sets the current file info)
+					unzSetOffset(pak->handle, pakFile->pos);
+					// copy the file info into the unzip structure
+					Com_Memcpy(zfi, pak->handle, sizeof(unz_s));
+					// we copy this back into the structure
+					zfi->filestream = temp;
+					// open the file in the zip
+					unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
 #endif
-						fsh[*file].zipFilePos = pakFile->pos;
-						fsh[*file].zipFileLen = pakFile->len;
+					fsh[*file].zipFilePos = pakFile->pos;
+					fsh[*file].zipFileLen = pakFile->len;
 
-						if (fs_debug->integer) {
-							Com_Printf("FS_FOpenFileRead: %s (found in '%s')\n",
-								filename, pak->pakFilename);
-						}
-						return pakFile->len;
+					if (fs_debug->integer) {
+						Com_Printf("FS_FOpenFileRead: %s (found in '%s')\n",
+							filename, pak->pakFilename);
 					}
-					pakFile = pakFile->next;
-				} while (pakFile != nullptr);
+					return pakFile->len;
+				}
 			}
 			else if (search->dir) {
 				// check a file in the directory tree
@@ -1410,10 +1747,21 @@ long FS_FOpenFileRead(const char* filename, fileHandle_t* file, const qboolean u
 	} while (b_faster_to_re_open_using_new_local_file);
 
 	Com_DPrintf("Can't find %s\n", filename);
+	FS_NegCacheStore(filename);
 	*file = 0;
 	return -1;
 }
 
+long FS_FOpenFileRead(const char* filename, fileHandle_t* file, const qboolean uniqueFILE) {
+	levelIOTimer_t timer;
+
+	const long len = FS_FOpenFileRead_Actual(filename, file, uniqueFILE);
+	if (*file) {
+		FS_LevelLoadRecord(filename, LEVELFILE_OPENED);
+	}
+	return len;
+}
+
 /*
 =================
 FS_Read
@@ -1428,6 +1776,11 @@ int FS_Read(void* buffer, const int len, const fileHandle_t f) {
 		return 0;
 	}
 
+	levelIOTimer_t timer;
+	if (fs_levelLoading) {
+		fs_levelIOBytes += len;
+	}
+
 	auto buf = static_cast<byte*>(buffer);
 	fs_readCount += len;
 
@@ -1613,101 +1966,649 @@ int FS_Seek(const fileHandle_t f, const long offset, int origin) {
 /*
 ======================================================================================
 
-CONVENIENCE FUNCTIONS FOR ENTIRE FILES
+BACKGROUND PREFETCH
 
 ======================================================================================
 */
 
-int	FS_FileIsInPAK(const char* filename) {
-	long			hash = 0;
+/*
+=================
+FS_PrefetchFind
 
-	FS_AssertInitialised();
+Caller holds fs_prefetchMutex
+=================
+*/
+static prefetchEntry_t* FS_PrefetchFind(const char* filename, const long hash) {
+	if (!fs_prefetchCount) {
+		return nullptr;
+	}
 
-	if (!filename) {
-		Com_Error(ERR_FATAL, "FS_FOpenFileRead: NULL 'filename' parameter passed\n");
+	for (prefetchEntry_t& entry : fs_prefetchEntries) {
+		if (entry.state != PREFETCH_FREE && entry.hash == hash && !FS_FilenameCompare(entry.name, filename)) {
+			return &entry;
+		}
 	}
+	return nullptr;
+}
 
-	// qpaths are not supposed to have a leading slash
-	if (filename[0] == '/' || filename[0] == '\\') {
-		filename++;
+/*
+=================
+FS_PrefetchRelease
+
+Caller holds fs_prefetchMutex, and entry isn't READING
+=================
+*/
+static void FS_PrefetchRelease(prefetchEntry_t* entry) {
+	if (entry->state == PREFETCH_QUEUED) {
+		for (auto it = fs_prefetchQueue.begin(); it != fs_prefetchQueue.end(); ++it) {
+			if (&fs_prefetchEntries[*it] == entry) {
+				fs_prefetchQueue.erase(it);
+				break;
+			}
+		}
 	}
 
-	// make absolutely sure that it can't back up the path.
-	// The searchpaths do guarantee that something will always
-	// be prepended, so we don't need to worry about "c:" or "//limbo"
-	if (strstr(filename, "..") || strstr(filename, "::")) {
-		return -1;
+	if (entry->data) {
+		Z_Free(entry->data);
+		entry->data = nullptr;
 	}
+	entry->state = PREFETCH_FREE;
+	fs_prefetchBytes -= entry->len;
+	fs_prefetchCount--;
+}
 
-	//
-	// search through the path, one element at a time
-	//
+/*
+=================
+FS_PrefetchRead
 
-	for (const searchpath_t* search = fs_searchpaths; search; search = search->next) {
-		//
-		if (search->pack) {
-			hash = FS_HashFileName(filename, search->pack->hashSize);
+Worker thread. Each worker keeps its own unzFile on the last pk3 it read, since
+minizip handles can't be shared between threads and most jobs in a row are from
+the same pk3 anyway.
+=================
+*/
+static qboolean FS_PrefetchRead(unzFile* z, char* zName, const char* pakFilename, const unsigned long pos, byte* data, const long len) {
+	if (!*z || Q_stricmp(zName, pakFilename)) {
+		if (*z) {
+			unzClose(*z);
 		}
-		// is the element a pak file?
-		if (search->pack && search->pack->hashTable[hash]) {
-			// look through all the pak file elements
-			const pack_t* pak = search->pack;
-			const fileInPack_t* pakFile = pak->hashTable[hash];
-			do {
-				// case and separator insensitive comparisons
-				if (!FS_FilenameCompare(pakFile->name, filename)) {
-					return 1;
-				}
-				pakFile = pakFile->next;
-			} while (pakFile != nullptr);
+		*z = unzOpen(pakFilename);
+		Q_strncpyz(zName, pakFilename, MAX_OSPATH);
+		if (!*z) {
+			return qfalse;
 		}
 	}
-	return -1;
+
+	if (unzSetOffset(*z, pos) != UNZ_OK || unzOpenCurrentFile(*z) != UNZ_OK) {
+		return qfalse;
+	}
+
+	const qboolean read = unzReadCurrentFile(*z, data, len) == len ? qtrue : qfalse;
+	unzCloseCurrentFile(*z);
+	return read;
 }
 
 /*
-============
-FS_ReadFile
-
-Filename are relative to the quake search path
-a null buffer will just return the file length without loading
-============
+=================
+FS_PrefetchWorker
+=================
 */
-long FS_ReadFile(const char* qpath, void** buffer) {
-	fileHandle_t	h;
+static void FS_PrefetchWorker() {
+	unzFile z = nullptr;
+	char zName[MAX_OSPATH] = "";
 
-	FS_AssertInitialised();
+	Z_MinizipThreadMalloc(qtrue);	// keep this thread's minizip handles out of the zone
 
-	if (!qpath || !qpath[0]) {
-		Com_Error(ERR_FATAL, "FS_ReadFile with empty name\n");
-	}
+	std::unique_lock<std::mutex> lock(fs_prefetchMutex);
+	for (;;) {
+		fs_prefetchWake.wait(lock, [] { return fs_prefetchQuit || !fs_prefetchQueue.empty(); });
+		if (fs_prefetchQuit) {
+			break;
+		}
 
-	// stop sounds from repeating
-	S_ClearSoundBuffer();
+		prefetchEntry_t* entry = &fs_prefetchEntries[fs_prefetchQueue.front()];
+		fs_prefetchQueue.pop_front();
+		entry->state = PREFETCH_READING;
 
-	// look for it in the filesystem or pack files
-	const long len = FS_FOpenFileRead(qpath, &h, qfalse);
-	if (h == 0) {
-		if (buffer) {
-			*buffer = nullptr;
-		}
-		return -1;
-	}
+		// nothing else touches a READING entry, so its fields and data are safe without the lock
+		lock.unlock();
+		const qboolean read = FS_PrefetchRead(&z, zName, entry->pakFilename, entry->pos, entry->data, entry->len);
+		lock.lock();
 
-	if (!buffer) {
-		FS_FCloseFile(h);
-		return len;
+		entry->state = read ? PREFETCH_READY : PREFETCH_FAILED;
+		fs_prefetchDone.notify_all();
 	}
+	lock.unlock();
 
-	fs_loadCount++;
+	if (z) {
+		unzClose(z);
+	}
+}
 
-	const auto buf = static_cast<byte*>(Z_Malloc(len + 1, TAG_FILESYS, qfalse));
-	buf[len] = '\0';	// because we're not calling Z_Malloc with optional trailing 'bZeroIt' bool
-	*buffer = buf;
+/*
+=================
+FS_PrefetchShutdown
 
-	Z_Label(buf, qpath);
+Stops the workers and throws away anything they read that nobody took
+=================
+*/
+static void FS_PrefetchShutdown() {
+	if (fs_prefetchWorkers.empty()) {
+		return;
+	}
 
-	// PRECACE CHECKER!
+	{
+		std::lock_guard<std::mutex> lock(fs_prefetchMutex);
+		fs_prefetchQuit = true;
+	}
+	fs_prefetchWake.notify_all();
+	for (std::thread& worker : fs_prefetchWorkers) {
+		worker.join();
+	}
+	fs_prefetchWorkers.clear();
+
+	// no workers left, so no locking needed any more
+	fs_prefetchQueue.clear();
+	for (prefetchEntry_t& entry : fs_prefetchEntries) {
+		if (entry.state != PREFETCH_FREE) {
+			FS_PrefetchRelease(&entry);
+		}
+	}
+	fs_prefetchQuit = false;
+}
+
+/*
+=================
+FS_PrefetchDiscard
+=================
+*/
+static void FS_PrefetchDiscard(const char* filename) {
+	if (fs_prefetchWorkers.empty()) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(fs_prefetchMutex);
+	prefetchEntry_t* entry = FS_PrefetchFind(filename, FS_HashFullFileName(filename, MAX_PREFETCH_FILES));
+	if (entry) {
+		fs_prefetchDone.wait(lock, [entry] { return entry->state != PREFETCH_READING; });
+		FS_PrefetchRelease(entry);
+	}
+}
+
+/*
+=================
+FS_PrefetchTake
+
+If filename was prefetched, hands over its buffer, a TAG_FILESYS block just like FS_ReadFile's,
+and returns the length, waiting for the worker if it's still being read. Otherwise -1, and the caller
+reads it the usual way.
+=================
+*/
+static long FS_PrefetchTake(const char* filename, byte** data) {
+	*data = nullptr;
+
+	if (fs_prefetchWorkers.empty()) {
+		return -1;
+	}
+
+	levelIOTimer_t timer;
+
+	std::unique_lock<std::mutex> lock(fs_prefetchMutex);
+	prefetchEntry_t* entry = FS_PrefetchFind(filename, FS_HashFullFileName(filename, MAX_PREFETCH_FILES));
+	if (!entry) {
+		return -1;
+	}
+
+	if (entry->state == PREFETCH_READING) {
+		fs_prefetchDone.wait(lock, [entry] { return entry->state != PREFETCH_READING; });
+	}
+
+	long len = -1;
+	if (entry->state == PREFETCH_READY) {
+		*data = entry->data;
+		entry->data = nullptr;
+		len = entry->len;
+	}
+	// a QUEUED one is cheaper to just read here than to wait for
+	FS_PrefetchRelease(entry);
+	return len;
+}
+
+/*
+=================
+FS_PrefetchFile
+
+Queues pk3 entries to be read and inflated in the background, ahead of FS_ReadFile
+asking for them. Purely a hint: loose files, anything already queued and anything over
+the fs_prefetchMB budget are just skipped. Each call's files are queued in pk3 order, so
+the workers read each pk3 front to back instead of seeking about.
+=================
+*/
+void FS_PrefetchFile(const char* const* qpaths, const int numFiles) {
+	FS_AssertInitialised();
+
+	levelIOTimer_t timer;
+
+	if (!fs_prefetch->integer || fs_prefetchThreads->integer <= 0) {
+		return;
+	}
+
+	if (fs_prefetchWorkers.empty()) {
+		const int numThreads = Com_Clampi(1, 8, fs_prefetchThreads->integer);
+		for (int i = 0; i < numThreads; i++) {
+			fs_prefetchWorkers.emplace_back(FS_PrefetchWorker);
+		}
+	}
+
+	const long budget = fs_prefetchMB->integer * 1024L * 1024L;
+	const qboolean recording = fs_levelRecording;
+	fs_levelRecording = qfalse;	// these opens aren't the level's
+
+	std::vector<int> batch;
+
+	for (int i = 0; i < numFiles; i++) {
+		const char* filename = qpaths[i];
+		if (filename[0] == '/' || filename[0] == '\\') {
+			filename++;
+		}
+		if (strlen(filename) >= MAX_QPATH) {
+			continue;
+		}
+
+		const long hash = FS_HashFullFileName(filename, MAX_PREFETCH_FILES);
+		{
+			std::lock_guard<std::mutex> lock(fs_prefetchMutex);
+			if (FS_PrefetchFind(filename, hash)) {
+				continue;
+			}
+		}
+
+		// let the usual search decide where it comes from
+		fileHandle_t h;
+		const long len = FS_FOpenFileRead(filename, &h, qfalse);
+		if (!h) {
+			continue;
+		}
+		const qboolean zipFile = fsh[h].zipFile;
+		const unsigned long pos = fsh[h].zipFilePos;
+		const pack_t* pak = fsh[h].zipPak;
+		const unsigned long dataPos = zipFile ? static_cast<unsigned long>(unzGetCurrentFileZStreamPos64(fsh[h].handleFiles.file.z)) : 0;
+		FS_FCloseFile(h);
+
+		if (!zipFile || len <= 0) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(fs_prefetchMutex);
+		if (fs_prefetchCount == MAX_PREFETCH_FILES || fs_prefetchBytes + len > budget) {
+			continue;
+		}
+
+		int slot = 0;
+		while (fs_prefetchEntries[slot].state != PREFETCH_FREE) {
+			slot++;
+		}
+		prefetchEntry_t* entry = &fs_prefetchEntries[slot];
+		entry->state = PREFETCH_QUEUED;
+		entry->hash = hash;
+		Q_strncpyz(entry->name, filename, sizeof(entry->name));
+		Q_strncpyz(entry->pakFilename, pak->pakFilename, sizeof(entry->pakFilename));
+		entry->pos = pos;
+		entry->dataPos = dataPos;
+		entry->len = len;
+		entry->data = static_cast<byte*>(Z_Malloc(len + 1, TAG_FILESYS, qfalse));
+		entry->data[len] = 0;
+		fs_prefetchCount++;
+		fs_prefetchBytes += len;
+		batch.push_back(slot);
+	}
+
+	fs_levelRecording = recording;
+
+	if (batch.empty()) {
+		return;
+	}
+
+	std::sort(batch.begin(), batch.end(), [](const int a, const int b) {
+		const prefetchEntry_t& ea = fs_prefetchEntries[a];
+		const prefetchEntry_t& eb = fs_prefetchEntries[b];
+		const int pakOrder = strcmp(ea.pakFilename, eb.pakFilename);
+		return pakOrder ? pakOrder < 0 : ea.dataPos < eb.dataPos;
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(fs_prefetchMutex);
+		fs_prefetchQueue.insert(fs_prefetchQueue.end(), batch.begin(), batch.end());
+	}
+	fs_prefetchWake.notify_all();
+}
+
+/*
+=================
+FS_LevelManifestName
+
+Kept with the saves, since like them it's per user and safe to throw away
+=================
+*/
+static const char* FS_LevelManifestName(const char* mapname) {
+	return va("saves/manifests/%s.fsm", mapname);
+}
+
+/*
+=================
+FS_LevelLoadRecord
+=================
+*/
+static void FS_LevelLoadRecord(const char* filename, const int flags) {
+	if (!fs_levelRecording) {
+		return;
+	}
+
+	if (filename[0] == '/' || filename[0] == '\\') {
+		filename++;
+	}
+	if (strlen(filename) >= MAX_QPATH) {
+		return;
+	}
+
+	std::string name(filename);
+	Q_strlwr(&name[0]);
+	std::replace(name.begin(), name.end(), '\\', '/');
+
+	const auto seen = fs_levelFilesSeen.emplace(name, fs_levelFiles.size());
+	if (seen.second) {
+		fs_levelFiles.push_back({ name, flags });
+	}
+	else {
+		fs_levelFiles[seen.first->second].flags |= flags;
+	}
+}
+
+/*
+=================
+FS_WriteManifest
+
+"FSMF", version, file count, then per file its flags, how many leading chars it shares
+with the previous name and the rest of the name, all in bytes. Sorted by name so those
+shared prefixes are long (models/players/..., sound/chars/... and so on).
+=================
+*/
+#define MANIFEST_IDENT		(('F'<<24)+('M'<<16)+('S'<<8)+'F')
+#define MANIFEST_VERSION	1
+
+static void FS_WriteManifest(const char* filename, std::vector<levelFile_t>& files) {
+	std::sort(files.begin(), files.end(), [](const levelFile_t& a, const levelFile_t& b) { return a.name < b.name; });
+
+	std::vector<byte> manifest;
+	const int header[3] = { LittleLong(MANIFEST_IDENT), LittleLong(MANIFEST_VERSION), LittleLong(static_cast<int>(files.size())) };
+	manifest.insert(manifest.end(), reinterpret_cast<const byte*>(header), reinterpret_cast<const byte*>(header + 3));
+
+	const std::string* prev = nullptr;
+	for (const levelFile_t& file : files) {
+		size_t shared = 0;
+		if (prev) {
+			while (shared < prev->size() && shared < file.name.size() && (*prev)[shared] == file.name[shared]) {
+				shared++;
+			}
+		}
+
+		manifest.push_back(static_cast<byte>(file.flags));
+		manifest.push_back(static_cast<byte>(shared));
+		manifest.push_back(static_cast<byte>(file.name.size() - shared));
+		manifest.insert(manifest.end(), file.name.begin() + shared, file.name.end());
+		prev = &file.name;
+	}
+
+	FS_WriteFile(filename, manifest.data(), static_cast<int>(manifest.size()));
+}
+
+/*
+=================
+FS_ReadManifest
+
+Empty if there isn't one, or it's not one we understand
+=================
+*/
+static std::vector<levelFile_t> FS_ReadManifest(const char* filename) {
+	std::vector<levelFile_t> files;
+
+	byte* manifest;
+	const long len = FS_ReadFile(filename, reinterpret_cast<void**>(&manifest));
+	if (!manifest) {
+		return files;
+	}
+
+	int header[3];
+	if (len >= static_cast<long>(sizeof(header))) {
+		Com_Memcpy(header, manifest, sizeof(header));
+	}
+	if (len < static_cast<long>(sizeof(header)) || LittleLong(header[0]) != MANIFEST_IDENT || LittleLong(header[1]) != MANIFEST_VERSION) {
+		Com_DPrintf("FS_ReadManifest: ignoring bad manifest %s\n", filename);
+		FS_FreeFile(manifest);
+		return files;
+	}
+
+	const int numFiles = LittleLong(header[2]);
+	const byte* p = manifest + sizeof(header);
+	const byte* end = manifest + len;
+	std::string name;
+
+	for (int i = 0; i < numFiles && p + 3 <= end; i++) {
+		const int flags = p[0];
+		const size_t shared = p[1];
+		const size_t rest = p[2];
+		p += 3;
+		if (shared > name.size() || p + rest > end) {
+			break;
+		}
+
+		name.resize(shared);
+		name.append(reinterpret_cast<const char*>(p), rest);
+		p += rest;
+		files.push_back({ name, flags });
+	}
+
+	FS_FreeFile(manifest);
+	return files;
+}
+
+/*
+=================
+FS_PrefetchManifest
+
+Prefetches the whole-file reads in a manifest, returns how many there were
+=================
+*/
+static int FS_PrefetchManifest(const std::vector<levelFile_t>& files) {
+	std::vector<const char*> qpaths;
+	for (const levelFile_t& file : files) {
+		if (file.flags & LEVELFILE_READ) {
+			qpaths.push_back(file.name.c_str());
+		}
+	}
+
+	FS_PrefetchFile(qpaths.data(), static_cast<int>(qpaths.size()));
+	return static_cast<int>(qpaths.size());
+}
+
+/*
+=================
+FS_LevelLoadBegin
+
+Starts prefetching whatever the last load of this map read, and starts recording
+what this one opens
+=================
+*/
+void FS_LevelLoadBegin(const char* mapname) {
+	FS_AssertInitialised();
+
+	fs_levelLoading = qfalse;
+	fs_levelRecording = qfalse;
+	fs_levelFiles.clear();
+	fs_levelFilesSeen.clear();
+	Q_strncpyz(fs_levelName, mapname, sizeof(fs_levelName));
+
+	fs_levelIOTime = std::chrono::steady_clock::duration::zero();
+	fs_levelIOBytes = 0;
+	fs_levelIODepth = 0;
+	fs_levelStart = std::chrono::steady_clock::now();
+	fs_levelLoading = qtrue;
+
+	FS_PrefetchManifest(FS_ReadManifest(FS_LevelManifestName(mapname)));
+
+	fs_levelRecording = qtrue;
+}
+
+/*
+=================
+FS_LevelLoadEnd
+
+Writes out the manifest for the next load of this map, and tells developers how the load
+time split between the filesystem and everything else (mostly decoding)
+=================
+*/
+void FS_LevelLoadEnd() {
+	if (!fs_levelLoading) {
+		return;
+	}
+	fs_levelLoading = qfalse;
+	fs_levelRecording = qfalse;
+
+	using std::chrono::duration_cast;
+	using std::chrono::milliseconds;
+	const int totalMsec = static_cast<int>(duration_cast<milliseconds>(std::chrono::steady_clock::now() - fs_levelStart).count());
+	const int ioMsec = static_cast<int>(duration_cast<milliseconds>(fs_levelIOTime).count());
+
+	int numRead = 0;
+	for (const levelFile_t& file : fs_levelFiles) {
+		if (file.flags & LEVELFILE_READ) {
+			numRead++;
+		}
+	}
+	Com_DPrintf("%s loaded in %d msec: %d msec file I/O (%d files, %d read whole, %ld KB), %d msec decode and the rest\n",
+		fs_levelName, totalMsec, ioMsec, static_cast<int>(fs_levelFiles.size()), numRead, fs_levelIOBytes / 1024, totalMsec - ioMsec);
+
+	if (!fs_levelFiles.empty()) {
+		FS_WriteManifest(FS_LevelManifestName(fs_levelName), fs_levelFiles);
+	}
+
+	fs_levelFiles.clear();
+	fs_levelFilesSeen.clear();
+
+	// anything still sitting there wasn't wanted after all
+	if (!fs_prefetchWorkers.empty()) {
+		std::unique_lock<std::mutex> lock(fs_prefetchMutex);
+		for (prefetchEntry_t& entry : fs_prefetchEntries) {
+			if (entry.state != PREFETCH_FREE) {
+				fs_prefetchDone.wait(lock, [&entry] { return entry.state != PREFETCH_READING; });
+				FS_PrefetchRelease(&entry);
+			}
+		}
+	}
+}
+
+/*
+======================================================================================
+
+CONVENIENCE FUNCTIONS FOR ENTIRE FILES
+
+======================================================================================
+*/
+
+int	FS_FileIsInPAK(const char* filename) {
+	FS_AssertInitialised();
+
+	if (!filename) {
+		Com_Error(ERR_FATAL, "FS_FOpenFileRead: NULL 'filename' parameter passed\n");
+	}
+
+	// qpaths are not supposed to have a leading slash
+	if (filename[0] == '/' || filename[0] == '\\') {
+		filename++;
+	}
+
+	// make absolutely sure that it can't back up the path.
+	// The searchpaths do guarantee that something will always
+	// be prepended, so we don't need to worry about "c:" or "//limbo"
+	if (strstr(filename, "..") || strstr(filename, "::")) {
+		return -1;
+	}
+
+	// one probe does it once the index is up
+	if (fs_fileIndex) {
+		return FS_FileIndexLookup(filename) ? 1 : -1;
+	}
+
+	//
+	// search through the path, one element at a time
+	//
+
+	for (const searchpath_t* search = fs_searchpaths; search; search = search->next) {
+		// is the element a pak file?
+		if (search->pack && FS_FindFileInPack(search, filename, nullptr)) {
+			return 1;
+		}
+	}
+	return -1;
+}
+
+/*
+============
+FS_ReadFile
+
+Filename are relative to the quake search path
+a null buffer will just return the file length without loading
+============
+*/
+long FS_ReadFile(const char* qpath, void** buffer) {
+	fileHandle_t	h;
+
+	FS_AssertInitialised();
+
+	if (!qpath || !qpath[0]) {
+		Com_Error(ERR_FATAL, "FS_ReadFile with empty name\n");
+	}
+
+	// stop sounds from repeating
+	S_ClearSoundBuffer();
+
+	// already read and inflated in the background?
+	if (buffer) {
+		byte* prefetched;
+		const long len = FS_PrefetchTake(qpath, &prefetched);
+		if (prefetched) {
+			fs_loadCount++;
+			*buffer = prefetched;
+
+			Z_Label(prefetched, qpath);
+			FS_LevelLoadRecord(qpath, LEVELFILE_OPENED | LEVELFILE_READ);
+			return len;
+		}
+	}
+
+	// look for it in the filesystem or pack files
+	const long len = FS_FOpenFileRead(qpath, &h, qfalse);
+	if (h == 0) {
+		if (buffer) {
+			*buffer = nullptr;
+		}
+		return -1;
+	}
+
+	if (!buffer) {
+		FS_FCloseFile(h);
+		return len;
+	}
+
+	fs_loadCount++;
+	FS_LevelLoadRecord(qpath, LEVELFILE_READ);
+
+	const auto buf = static_cast<byte*>(Z_Malloc(len + 1, TAG_FILESYS, qfalse));
+	buf[len] = '\0';	// because we're not calling Z_Malloc with optional trailing 'bZeroIt' bool
+	*buffer = buf;
+
+	Z_Label(buf, qpath);
+
+	// PRECACE CHECKER!
 #ifndef FINAL_BUILD
 	if (com_sv_running && com_sv_running->integer && cls.state >= CA_ACTIVE) {	//com_cl_running
 		if (strncmp(qpath, "menu/", 5)) {
@@ -1724,6 +2625,162 @@ long FS_ReadFile(const char* qpath, void** buffer) {
 	return len;
 }
 
+/*
+============
+FS_ReadFiles
+
+FS_ReadFile for a batch of independent files. The pk3 entries among them all go to
+the prefetch workers first, so they inflate side by side while this thread reads
+whichever ones the workers haven't started on. Returns once every one is in, with
+buffers[i] and lens[i] as FS_ReadFile would have given them (NULL and -1 if not
+found). Returns how many were found.
+============
+*/
+int FS_ReadFiles(const char* const* qpaths, void** buffers, long* lens, const int numFiles) {
+	FS_AssertInitialised();
+
+	if (numFiles > 1) {
+		FS_PrefetchFile(qpaths, numFiles);
+	}
+
+	int numFound = 0;
+	for (int i = 0; i < numFiles; i++) {
+		lens[i] = FS_ReadFile(qpaths[i], &buffers[i]);
+		if (buffers[i]) {
+			numFound++;
+		}
+	}
+	return numFound;
+}
+
+// mappings last as long as their pak, so on 32-bit builds only this much of the
+// address space goes to them; paks past it are read the old way
+#define MAX_PAK_MAPPED_BYTES_32	(256 * 1024 * 1024)
+
+static size_t fs_pakMappedBytes;	// total over every live pak mapping
+
+/*
+=================
+FS_ReleasePakMapping
+=================
+*/
+static void FS_ReleasePakMapping(pakMapping_t* mapping) {
+	if (--mapping->refs == 0) {
+		fs_pakMappedBytes -= mapping->size;
+		Sys_UnmapFile(mapping->base, mapping->size);
+		Z_Free(mapping);
+	}
+}
+
+/*
+=================
+FS_PakMapping
+
+Maps the whole pk3 the first time anything wants a pointer into it,
+within MAX_PAK_MAPPED_BYTES_32 on 32-bit builds
+=================
+*/
+static pakMapping_t* FS_PakMapping(pack_t* pak) {
+	if (!pak->mapping && !pak->mapFailed) {
+		size_t size;
+		void* base = Sys_MapFile(pak->pakFilename, &size);
+		if (!base) {
+			Com_DPrintf("FS_MapFile: couldn't map %s, falling back to reads\n", pak->pakFilename);
+			pak->mapFailed = qtrue;
+			return nullptr;
+		}
+		if (sizeof(void*) < 8 && fs_pakMappedBytes + size > MAX_PAK_MAPPED_BYTES_32) {
+			Com_DPrintf("FS_MapFile: not mapping %s, %u bytes of paks are mapped already\n", pak->pakFilename, static_cast<unsigned>(fs_pakMappedBytes));
+			Sys_UnmapFile(base, size);
+			pak->mapFailed = qtrue;
+			return nullptr;
+		}
+
+		fs_pakMappedBytes += size;
+		pak->mapping = static_cast<pakMapping_t*>(Z_Malloc(sizeof(pakMapping_t), TAG_FILESYS, qfalse));
+		pak->mapping->base = static_cast<byte*>(base);
+		pak->mapping->size = size;
+		pak->mapping->refs = 1;	// the pak's own
+	}
+	return pak->mapping;
+}
+
+/*
+============
+FS_MapFile
+
+Like FS_ReadFile, but for entries stored uncompressed in a pk3 the buffer points
+straight into a mapping of the pk3 instead of being a copy. The mapping is
+copy-on-write, so the caller may still scribble on it, but unlike FS_ReadFile
+there is NO trailing 0. Returns -1 and a NULL buffer for anything it can't map
+(loose files, compressed entries, fs_mmap 0); callers fall back to FS_ReadFile.
+Free with FS_FreeFile either way.
+============
+*/
+long FS_MapFile(const char* qpath, void** buffer) {
+	fileHandle_t	h;
+
+	FS_AssertInitialised();
+
+	if (!qpath || !qpath[0]) {
+		Com_Error(ERR_FATAL, "FS_MapFile with empty name\n");
+	}
+
+	*buffer = nullptr;
+
+	if (!fs_mmap->integer || fs_mappedFileCount == MAX_MAPPED_FILES) {
+		return -1;
+	}
+
+	const long len = FS_FOpenFileRead(qpath, &h, qfalse);
+	if (h == 0) {
+		return -1;
+	}
+
+	const void* data = nullptr;
+	pakMapping_t* mapping = nullptr;
+
+	if (fsh[h].zipFile && len > 0) {
+		unz_file_info info;
+		unzFile z = fsh[h].handleFiles.file.z;
+
+		// only plain stored entries are byte for byte the file
+		if (unzGetCurrentFileInfo(z, &info, nullptr, 0, nullptr, 0, nullptr, 0) == UNZ_OK
+			&& info.compression_method == 0 && !(info.flag & 1)) {
+			mapping = FS_PakMapping(fsh[h].zipPak);
+			if (mapping) {
+				const ZPOS64_T offset = unzGetCurrentFileZStreamPos64(z);
+				if (offset && offset + len <= mapping->size) {
+					data = mapping->base + offset;
+				}
+			}
+		}
+	}
+	FS_FCloseFile(h);
+
+	if (!data) {
+		return -1;
+	}
+
+	for (mappedFile_t& mapped : fs_mappedFiles) {
+		if (!mapped.data) {
+			mapped.data = data;
+			mapped.mapping = mapping;
+			break;
+		}
+	}
+	fs_mappedFileCount++;
+	mapping->refs++;
+	fs_loadCount++;
+
+	if (fs_debug->integer) {
+		Com_Printf("FS_MapFile: %s (%ld bytes, no copy)\n", qpath, len);
+	}
+
+	*buffer = const_cast<void*>(data);
+	return len;
+}
+
 /*
 =============
 FS_FreeFile
@@ -1735,6 +2792,18 @@ void FS_FreeFile(void* buffer) {
 		Com_Error(ERR_FATAL, "FS_FreeFile( NULL )");
 	}
 
+	if (fs_mappedFileCount) {
+		for (mappedFile_t& mapped : fs_mappedFiles) {
+			if (mapped.data == buffer) {
+				FS_ReleasePakMapping(mapped.mapping);
+				mapped.data = nullptr;
+				mapped.mapping = nullptr;
+				fs_mappedFileCount--;
+				return;
+			}
+		}
+	}
+
 	Z_Free(buffer);
 }
 
@@ -1880,10 +2949,81 @@ Frees a pak structure and releases all associated resources
 static void FS_FreePak(pack_t* thepak)
 {
 	unzClose(thepak->handle);
+	if (thepak->mapping) {
+		FS_ReleasePakMapping(thepak->mapping);
+	}
 	Z_Free(thepak->buildBuffer);
 	Z_Free(thepak);
 }
 
+/*
+=================
+FS_BuildFileIndex
+
+Maps every file in every pak to the pak that wins it in search order, so a
+lookup is one hash probe instead of one per pak (misses included). Only
+valid for the current fs_searchpaths, so it gets rebuilt on every FS_Startup.
+=================
+*/
+static void FS_FreeFileIndex()
+{
+	if (fs_fileIndex) {
+		Z_Free(fs_fileIndex);
+	}
+	fs_fileIndex = nullptr;
+	fs_fileIndexSize = 0;
+	fs_fileIndexCount = 0;
+}
+
+static void FS_BuildFileIndex()
+{
+	FS_FreeFileIndex();
+
+	int hashSize = 1;
+	while (hashSize < fs_packFiles * 2) {
+		hashSize <<= 1;
+	}
+
+	// table and entries in one block
+	const auto index = static_cast<fileIndexEntry_t**>(Z_Malloc(hashSize * sizeof(fileIndexEntry_t*) + fs_packFiles * sizeof(fileIndexEntry_t), TAG_FILESYS, qtrue));
+	const auto entries = reinterpret_cast<fileIndexEntry_t*>(index + hashSize);
+	int numEntries = 0;
+
+	// earlier in the search path wins, so anything that's already in there stays
+	for (const searchpath_t* search = fs_searchpaths; search; search = search->next) {
+		if (!search->pack) {
+			continue;
+		}
+
+		const pack_t* pak = search->pack;
+		for (int i = 0; i < pak->numfiles && numEntries < fs_packFiles; i++) {
+			const fileInPack_t* pakFile = &pak->buildBuffer[i];
+			if (!pakFile->name) {
+				continue;	// FS_LoadZipFile stopped short on a bad entry
+			}
+
+			const long hash = FS_HashFullFileName(pakFile->name, hashSize);
+			const fileIndexEntry_t* existing = index[hash];
+			while (existing && FS_FilenameCompare(existing->pakFile->name, pakFile->name)) {
+				existing = existing->next;
+			}
+			if (existing) {
+				continue;
+			}
+
+			fileIndexEntry_t* entry = &entries[numEntries++];
+			entry->pakFile = pakFile;
+			entry->search = search;
+			entry->next = index[hash];
+			index[hash] = entry;
+		}
+	}
+
+	fs_fileIndex = index;
+	fs_fileIndexSize = hashSize;
+	fs_fileIndexCount = numEntries;
+}
+
 /*
 =================================================================================
 
@@ -2713,6 +3853,10 @@ void FS_Shutdown() {
 		}
 	}
 
+	FS_PrefetchShutdown();
+	FS_FreeFileIndex();
+	FS_NegCacheFlush();
+
 	// free everything
 	for (searchpath_t* p = fs_searchpaths; p; p = next) {
 		next = p->next;
@@ -2734,6 +3878,7 @@ void FS_Shutdown() {
 	Cmd_RemoveCommand("fdir");
 	Cmd_RemoveCommand("touchFile");
 	Cmd_RemoveCommand("which");
+	Cmd_RemoveCommand("fs_negcache");
 }
 
 /*
@@ -2761,6 +3906,11 @@ static void FS_Startup(const char* gameName) {
 	//fs_gamedirvar = Cvar_Get("fs_game", "MD-MP", CVAR_INIT | CVAR_SYSTEMINFO);
 
 	fs_dirbeforepak = Cvar_Get("fs_dirbeforepak", "0", CVAR_INIT | CVAR_PROTECTED);
+	fs_negativeCache = Cvar_Get("fs_negativeCache", "1", CVAR_ARCHIVE_ND);
+	fs_mmap = Cvar_Get("fs_mmap", "1", CVAR_ARCHIVE_ND);
+	fs_prefetch = Cvar_Get("fs_prefetch", "1", CVAR_ARCHIVE_ND);
+	fs_prefetchThreads = Cvar_Get("fs_prefetchThreads", "2", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	fs_prefetchMB = Cvar_Get("fs_prefetchMB", "64", CVAR_ARCHIVE_ND);
 
 	Cvar_Get("com_outcast", "0", CVAR_ARCHIVE | CVAR_SAVEGAME | CVAR_NORESTART);
 
@@ -2829,14 +3979,17 @@ static void FS_Startup(const char* gameName) {
 	Cmd_AddCommand("fdir", FS_NewDir_f);
 	Cmd_AddCommand("touchFile", FS_TouchFile_f);
 	Cmd_AddCommand("which", FS_Which_f);
+	Cmd_AddCommand("fs_negcache", FS_NegCache_f);
 
 	// print the current search paths
 	FS_Path_f();
 
+	FS_BuildFileIndex();
+
 	fs_gamedirvar->modified = qfalse; // We just loaded, it's not modified
 
 	Com_Printf("----------------------\n");
-	Com_Printf("%d files in pk3 files\n", fs_packFiles);
+	Com_Printf("%d files in pk3 files (%d unique)\n", fs_packFiles, fs_fileIndexCount);
 }
 
 /*
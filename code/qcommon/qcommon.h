@@ -518,8 +518,26 @@ long FS_ReadFile(const char* qpath, void** buffer);
 void FS_ForceFlush(fileHandle_t f);
 // forces flush on files we're writing to.
 
+long FS_MapFile(const char* qpath, void** buffer);
+// zero-copy FS_ReadFile for entries stored uncompressed in a pk3, the buffer points
+// into a copy-on-write mapping of the pk3 and has NO trailing 0.
+// returns -1 and a NULL buffer if the file can't be mapped, use FS_ReadFile then
+
 void FS_FreeFile(void* buffer);
-// frees the memory returned by FS_ReadFile
+// frees the memory returned by FS_ReadFile or FS_MapFile
+
+int FS_ReadFiles(const char* const* qpaths, void** buffers, long* lens, int numFiles);
+// FS_ReadFile for several files at once, inflating the pk3 ones in parallel.
+// Returns the number found, the missing ones get a NULL buffer and -1 length
+
+void FS_PrefetchFile(const char* const* qpaths, int numFiles);
+// starts reading and inflating pk3 entries in the background, FS_ReadFile
+// takes them from there instead of reading them itself
+
+void FS_LevelLoadBegin(const char* mapname);
+void FS_LevelLoadEnd();
+// bracket a level load: prefetches what the last load of the same map read,
+// records everything this one opens for next time, and reports I/O vs decode time
 
 void FS_WriteFile(const char* qpath, const void* buffer, int size);
 // writes a complete file, creating any subdirectories needed
@@ -684,6 +702,7 @@ void Z_TagFree(const memtag_t eTag);
 int Z_Free(void* pvAddress); //returns bytes freed
 int Z_Size(void* pvAddress);
 void Z_MorphMallocTag(void* pvAddress, const memtag_t eDesiredTag);
+void Z_MinizipThreadMalloc(qboolean bMalloc); // minizip on the calling thread uses malloc, not the zone
 qboolean Z_IsFromZone(const void* pvAddress, memtag_t eTag); //returns size if true
 
 #ifdef DEBUG_ZONE_ALLOCS
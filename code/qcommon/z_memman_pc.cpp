@@ -58,6 +58,7 @@ using zoneHeader_t = struct zoneHeader_s
 	int iMagic;
 	memtag_t eTag;
 	int iSize;
+	int iSlabClass; // 0 = malloc'd, ZONE_ARENA_CLASS/ZONE_GUARD_CLASS, else 1-based index into ZoneSlabClasses
 	zoneHeader_s* pNext;
 	zoneHeader_s* pPrev;
 
@@ -102,62 +103,587 @@ using zone_t = struct zone_s
 	zoneHeader_t Header;
 };
 
-cvar_t* com_validateZone;
+cvar_t* com_validateZone; // 1 = walk every block on every alloc, 2 = just com_validateZoneWindow of them, rotating
+cvar_t* com_validateZoneWindow;
+cvar_t* com_zoneGuardTag;
+cvar_t* com_zoneSlabMax;
 
 zone_t TheZone = {};
 
-// Scans through the linked list of mallocs and makes sure no data has been overwritten
+// Small-block slabs...
+//
+// Level loads, Ghoul2 and ICARUS do tens of thousands of tiny allocs, so anything up to com_zoneSlabMax bytes
+//	is carved out of big malloc'd pages per size-class and recycled through a free list instead of going through
+//	malloc/free each time. The blocks still get a normal header/tail and are still linked into TheZone.Header, so
+//	the tag stats, Z_TagFree, Z_Size, Z_IsFromZone and zone_details etc don't know or care where they came from.
+//
+#define ZONE_SLAB_PAGE_SIZE		(64*1024)
+#define ZONE_SLAB_MAX_DEFAULT	"1024"
 
-int Z_Validate()
+static const int ZoneSlabSizes[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+#define ZONE_SLAB_CLASSES		(sizeof(ZoneSlabSizes) / sizeof(ZoneSlabSizes[0]))
+#define ZONE_SLAB_MAX_SIZE		ZoneSlabSizes[ZONE_SLAB_CLASSES - 1]
+
+using zoneSlabPage_t = struct zoneSlabPage_s
+{
+	zoneSlabPage_s* pNext;
+	int iClass;
+};
+#define ZONE_SLAB_PAGE_HEADER_SIZE	((sizeof(zoneSlabPage_t) + 15) & ~15)
+
+using zoneSlabClass_t = struct
+{
+	zoneHeader_t* pFree; // chained through pNext, magic is 'FREE' while they're sitting in here
+	int iBlockSize; // whole block, header + data + tail, 16-byte rounded
+	int iBlocksTotal;
+	int iBlocksFree;
+};
+
+static zoneSlabClass_t ZoneSlabClasses[ZONE_SLAB_CLASSES];
+static zoneSlabPage_t* gpZoneSlabPages = nullptr;
+static int giZoneSlabPageCount = 0;
+
+static int Zone_SlabClassForSize(const int iSize)
+{
+	const int iMax = com_zoneSlabMax ? com_zoneSlabMax->integer : atoi(ZONE_SLAB_MAX_DEFAULT);
+	if (iSize > iMax || iSize > ZONE_SLAB_MAX_SIZE)
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < static_cast<int>(ZONE_SLAB_CLASSES); i++)
+	{
+		if (iSize <= ZoneSlabSizes[i])
+		{
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+// returns qfalse if we couldn't get a new page, caller just drops back to malloc()...
+//
+static qboolean Zone_SlabAddPage(const int iClass)
+{
+	zoneSlabClass_t& slabClass = ZoneSlabClasses[iClass - 1];
+	if (!slabClass.iBlockSize)
+	{
+		slabClass.iBlockSize = (sizeof(zoneHeader_t) + ZoneSlabSizes[iClass - 1] + sizeof(zoneTail_t) + 15) & ~15;
+	}
+
+	const auto pPage = static_cast<zoneSlabPage_t*>(malloc(ZONE_SLAB_PAGE_SIZE));
+	if (!pPage)
+	{
+		return qfalse;
+	}
+	pPage->iClass = iClass;
+	pPage->pNext = gpZoneSlabPages;
+	gpZoneSlabPages = pPage;
+	giZoneSlabPageCount++;
+
+	const int iBlocks = (ZONE_SLAB_PAGE_SIZE - ZONE_SLAB_PAGE_HEADER_SIZE) / slabClass.iBlockSize;
+	byte* pbBlock = reinterpret_cast<byte*>(pPage) + ZONE_SLAB_PAGE_HEADER_SIZE;
+	for (int i = 0; i < iBlocks; i++, pbBlock += slabClass.iBlockSize)
+	{
+		const auto pBlock = reinterpret_cast<zoneHeader_t*>(pbBlock);
+		pBlock->iMagic = INT_ID('F', 'R', 'E', 'E');
+		pBlock->iSlabClass = iClass;
+		pBlock->pNext = slabClass.pFree;
+		slabClass.pFree = pBlock;
+	}
+	slabClass.iBlocksTotal += iBlocks;
+	slabClass.iBlocksFree += iBlocks;
+
+	return qtrue;
+}
+
+static zoneHeader_t* Zone_SlabAlloc(const int iClass, const int iRealSize, const qboolean bZeroit)
+{
+	zoneSlabClass_t& slabClass = ZoneSlabClasses[iClass - 1];
+	if (!slabClass.pFree && !Zone_SlabAddPage(iClass))
+	{
+		return nullptr;
+	}
+
+	zoneHeader_t* pMemory = slabClass.pFree;
+	slabClass.pFree = pMemory->pNext;
+	slabClass.iBlocksFree--;
+
+	if (bZeroit)
+	{
+		memset(pMemory, 0, iRealSize);
+	}
+	pMemory->iSlabClass = iClass;
+	return pMemory;
+}
+
+static void Zone_SlabFree(zoneHeader_t* pMemory)
+{
+	zoneSlabClass_t& slabClass = ZoneSlabClasses[pMemory->iSlabClass - 1];
+	pMemory->pNext = slabClass.pFree;
+	slabClass.pFree = pMemory;
+	slabClass.iBlocksFree++;
+}
+
+static void Zone_SlabShutdown()
+{
+	while (gpZoneSlabPages)
+	{
+		zoneSlabPage_t* pNext = gpZoneSlabPages->pNext;
+		free(gpZoneSlabPages);
+		gpZoneSlabPages = pNext;
+	}
+	giZoneSlabPageCount = 0;
+	memset(ZoneSlabClasses, 0, sizeof(ZoneSlabClasses));
+}
+
+// Incremental validation cursor (com_validateZone 2)...  the list cursor and the arena cursor get nudged along
+//	whenever the block/chunk they're sitting on goes away, so the next window never starts on freed memory.
+//
+struct zoneArenaChunk_s;
+static zoneHeader_t* gpZoneValidateBlock = nullptr;
+static int giZoneValidateArenaTag = TAG_COUNT; // TAG_COUNT = not walking the arenas this lap
+static zoneArenaChunk_s* gpZoneValidateChunk = nullptr;
+static int giZoneValidateOffset = 0;
+
+static inline void Zone_ValidateBlockGone(const zoneHeader_t* pMemory)
+{
+	if (pMemory == gpZoneValidateBlock)
+	{
+		gpZoneValidateBlock = pMemory->pNext;
+	}
+}
+
+static inline void Zone_ValidateChunkGone(const zoneArenaChunk_s* pChunk, zoneArenaChunk_s* pResumeChunk)
+{
+	if (pChunk == gpZoneValidateChunk)
+	{
+		gpZoneValidateChunk = pResumeChunk;
+		giZoneValidateOffset = 0;
+	}
+}
+
+// Guard-page mode for one tag (com_zoneGuardTag)...
+//
+// Each block of that tag gets its own pages, pushed up so the tail ends (give or take the 16-byte alignment) right
+//	against a no-access page, so a write off the end faults on the spot instead of being found later by Z_Validate.
+//	Very wasteful, only meant for hunting down a specific overrun.
+//
+#define ZONE_GUARD_CLASS		-2 // iSlabClass value for a guard-paged block
+
+static int giZoneGuardTag = TAG_ALL; // TAG_ALL = off
+
+static void Zone_UpdateGuardTag()
+{
+	if (!com_zoneGuardTag || !com_zoneGuardTag->modified)
+	{
+		return;
+	}
+	com_zoneGuardTag->modified = qfalse;
+	giZoneGuardTag = TAG_ALL;
+
+	const char* psTagName = com_zoneGuardTag->string;
+	if (!Q_stricmpn(psTagName, "TAG_", 4))
+	{
+		psTagName += 4;
+	}
+	if (!psTagName[0])
+	{
+		return;
+	}
+
+	for (int i = TAG_ALL + 1; i < TAG_COUNT; i++)
+	{
+		if (!Q_stricmp(psTagName, psTagStrings[i]))
+		{
+			giZoneGuardTag = i;
+			Com_Printf("Zone guard pages on for TAG_%s\n", psTagStrings[i]);
+			return;
+		}
+	}
+	Com_Printf(S_COLOR_YELLOW"com_zoneGuardTag: unknown tag \"%s\"\n", com_zoneGuardTag->string);
+}
+
+static inline int ZoneGuardDataPages(const int iSize)
+{
+	const int iPageSize = Sys_PageSize();
+	return (sizeof(zoneHeader_t) + iSize + sizeof(zoneTail_t) + 15 + iPageSize - 1) / iPageSize; // +15 for alignment
+}
+
+static zoneHeader_t* Zone_GuardAlloc(const int iSize)
+{
+	const int iPageSize = Sys_PageSize();
+	const int iDataPages = ZoneGuardDataPages(iSize);
+
+	const auto pbPages = static_cast<byte*>(Sys_PageAlloc((iDataPages + 1) * static_cast<size_t>(iPageSize)));
+	if (!pbPages)
+	{
+		return nullptr;
+	}
+	byte* pbGuard = pbPages + iDataPages * iPageSize;
+	Sys_PageNoAccess(pbGuard, iPageSize);
+
+	const intptr_t iStart = reinterpret_cast<intptr_t>(pbGuard) - (sizeof(zoneHeader_t) + iSize + sizeof(zoneTail_t));
+	const auto pMemory = reinterpret_cast<zoneHeader_t*>(iStart & ~static_cast<intptr_t>(15));
+	pMemory->iSlabClass = ZONE_GUARD_CLASS; // pages come back zeroed, so bZeroit is a given
+	return pMemory;
+}
+
+static void Zone_GuardFree(zoneHeader_t* pMemory)
+{
+	// the tail ends less than 16 bytes short of the guard page, so rounding that up finds it again...
+	//
+	const int iPageSize = Sys_PageSize();
+	const int iDataPages = ZoneGuardDataPages(pMemory->iSize);
+	const intptr_t iEnd = reinterpret_cast<intptr_t>(ZoneTailFromHeader(pMemory) + 1);
+	const intptr_t iGuard = (iEnd + iPageSize - 1) & ~static_cast<intptr_t>(iPageSize - 1);
+
+	Sys_PageFree(reinterpret_cast<void*>(iGuard - iDataPages * iPageSize), (iDataPages + 1) * static_cast<size_t>(iPageSize));
+}
+
+// Per-tag arenas...
+//
+// Tags that only ever get thrown away in bulk at level change (hunk, BSP, G_Alloc) can be bump-allocated out of
+//	big chunks owned by that tag. Their blocks are NOT linked into TheZone.Header, so Z_TagFree() on them just
+//	hands the chunks back without walking every other block in the process, and Z_Free() of one only updates the
+//	counters (a chunk gets released early once nothing in it is live any more).
+//
+// The label/double-free debug builds walk TheZone.Header to find everything, so arenas are compiled out there.
+//
+#if !defined(DEBUG_ZONE_ALLOCS) && !defined(DETAILED_ZONE_DEBUG_CODE)
+#define ZONE_ARENAS
+#endif
+
+#define ZONE_ARENA_CLASS		-1 // iSlabClass value for an arena block
+#define ZONE_ARENA_CHUNK_SIZE	(1024*1024)
+
+using zoneArenaChunk_t = struct zoneArenaChunk_s
+{
+	zoneArenaChunk_s* pNext;
+	zoneArenaChunk_s* pPrev;
+	memtag_t eTag;
+	int iSize; // usable bytes after the chunk header
+	int iUsed;
+	int iLive; // blocks not yet Z_Free()'d
+};
+#define ZONE_ARENA_CHUNK_HEADER_SIZE	((sizeof(zoneArenaChunk_t) + 15) & ~15)
+
+using zoneArena_t = struct
+{
+	qboolean bEnabled;
+	zoneArenaChunk_t* pChunks; // head is the one we're currently bumping through
+	int iChunkCount;
+	int iChunkBytes;
+	int iLiveCount;
+	int iLiveBytes;
+};
+
+static zoneArena_t ZoneArenas[TAG_COUNT];
+
+// only tags that get thrown away wholesale with Z_TagFree(), anything freed a block at a time would pin its chunks...
+//
+static const memtag_t ZoneArenaDefaultTags[] = { TAG_HUNKALLOC, TAG_HUNKMISCMODELS, TAG_BSP };
+
+static inline int ZoneArenaStride(const int iSize)
+{
+	return (sizeof(zoneHeader_t) + iSize + sizeof(zoneTail_t) + 15) & ~15;
+}
+
+// arena blocks don't use the list pointers, so pPrev remembers the owning chunk instead...
+//
+static inline zoneArenaChunk_t* ZoneArenaChunkFromHeader(const zoneHeader_t* pHeader)
+{
+	return reinterpret_cast<zoneArenaChunk_t*>(pHeader->pPrev);
+}
+
+static void Zone_ArenaReleaseChunk(zoneArena_t& arena, zoneArenaChunk_t* pChunk)
+{
+	Zone_ValidateChunkGone(pChunk, pChunk->pNext);
+
+	if (pChunk->pPrev)
+	{
+		pChunk->pPrev->pNext = pChunk->pNext;
+	}
+	else
+	{
+		arena.pChunks = pChunk->pNext;
+	}
+	if (pChunk->pNext)
+	{
+		pChunk->pNext->pPrev = pChunk->pPrev;
+	}
+
+	arena.iChunkCount--;
+	arena.iChunkBytes -= pChunk->iSize;
+	free(pChunk);
+}
+
+static zoneHeader_t* Zone_ArenaAlloc(const memtag_t eTag, const int iSize, const qboolean bZeroit)
+{
+	zoneArena_t& arena = ZoneArenas[eTag];
+	const int iStride = ZoneArenaStride(iSize);
+
+	zoneArenaChunk_t* pChunk = arena.pChunks;
+	if (!pChunk || pChunk->iUsed + iStride > pChunk->iSize)
+	{
+		// big ones get a chunk of their own, so they can go straight back when they're freed...
+		//
+		const int iChunkSize = Q_max(iStride, ZONE_ARENA_CHUNK_SIZE);
+		pChunk = static_cast<zoneArenaChunk_t*>(malloc(ZONE_ARENA_CHUNK_HEADER_SIZE + iChunkSize));
+		if (!pChunk)
+		{
+			return nullptr; // caller will try the plain malloc path and all its mem-recovery stuff
+		}
+		pChunk->eTag = eTag;
+		pChunk->iSize = iChunkSize;
+		pChunk->iUsed = 0;
+		pChunk->iLive = 0;
+		if (iChunkSize > ZONE_ARENA_CHUNK_SIZE && arena.pChunks)
+		{
+			// goes in behind the head so the rest of the head chunk still gets bumped through...
+			//
+			zoneArenaChunk_t* pHead = arena.pChunks;
+			pChunk->pPrev = pHead;
+			pChunk->pNext = pHead->pNext;
+			if (pHead->pNext)
+			{
+				pHead->pNext->pPrev = pChunk;
+			}
+			pHead->pNext = pChunk;
+		}
+		else
+		{
+			pChunk->pPrev = nullptr;
+			pChunk->pNext = arena.pChunks;
+			if (arena.pChunks)
+			{
+				arena.pChunks->pPrev = pChunk;
+			}
+			arena.pChunks = pChunk;
+		}
+		arena.iChunkCount++;
+		arena.iChunkBytes += iChunkSize;
+	}
+
+	const auto pMemory = reinterpret_cast<zoneHeader_t*>(reinterpret_cast<byte*>(pChunk) +
+		ZONE_ARENA_CHUNK_HEADER_SIZE + pChunk->iUsed);
+	pChunk->iUsed += iStride;
+	pChunk->iLive++;
+	arena.iLiveCount++;
+	arena.iLiveBytes += iSize;
+
+	if (bZeroit)
+	{
+		memset(pMemory, 0, sizeof(zoneHeader_t) + iSize);
+	}
+	pMemory->iSlabClass = ZONE_ARENA_CLASS;
+	pMemory->pNext = nullptr;
+	pMemory->pPrev = reinterpret_cast<zoneHeader_t*>(pChunk);
+	return pMemory;
+}
+
+// counters only, the memory goes back when the whole chunk is empty or the tag gets Z_TagFree()'d...
+//
+static void Zone_ArenaFreeBlock(zoneHeader_t* pMemory)
+{
+	zoneArena_t& arena = ZoneArenas[pMemory->eTag];
+	zoneArenaChunk_t* pChunk = ZoneArenaChunkFromHeader(pMemory);
+
+	arena.iLiveCount--;
+	arena.iLiveBytes -= pMemory->iSize;
+	pMemory->iMagic = INT_ID('F', 'R', 'E', 'E');
+
+	if (!--pChunk->iLive)
+	{
+		if (pChunk == arena.pChunks)
+		{
+			pChunk->iUsed = 0; // current chunk, just rewind it
+			Zone_ValidateChunkGone(pChunk, pChunk);
+		}
+		else
+		{
+			Zone_ArenaReleaseChunk(arena, pChunk);
+		}
+	}
+}
+
+static void Zone_ArenaTagFree(const memtag_t eTag)
+{
+	zoneArena_t& arena = ZoneArenas[eTag];
+	if (!arena.pChunks)
+	{
+		return;
+	}
+
+	TheZone.Stats.iCount -= arena.iLiveCount;
+	TheZone.Stats.iCurrent -= arena.iLiveBytes;
+	TheZone.Stats.iCountsPerTag[eTag] -= arena.iLiveCount;
+	TheZone.Stats.iSizesPerTag[eTag] -= arena.iLiveBytes;
+
+	while (arena.pChunks)
+	{
+		Zone_ArenaReleaseChunk(arena, arena.pChunks);
+	}
+	arena.iLiveCount = 0;
+	arena.iLiveBytes = 0;
+}
+
+// calls func(pMemory) for every live arena block...
+//
+template <typename F>
+static void Zone_ForEachArenaBlock(F&& func)
+{
+	for (const auto& arena : ZoneArenas)
+	{
+		for (zoneArenaChunk_t* pChunk = arena.pChunks; pChunk; pChunk = pChunk->pNext)
+		{
+			byte* pbBlock = reinterpret_cast<byte*>(pChunk) + ZONE_ARENA_CHUNK_HEADER_SIZE;
+			byte* pbEnd = pbBlock + pChunk->iUsed;
+			while (pbBlock < pbEnd)
+			{
+				const auto pMemory = reinterpret_cast<zoneHeader_t*>(pbBlock);
+				pbBlock += ZoneArenaStride(pMemory->iSize);
+				if (pMemory->iMagic != INT_ID('F', 'R', 'E', 'E'))
+				{
+					func(pMemory);
+				}
+			}
+		}
+	}
+}
+
+static int Zone_ValidateBlock(zoneHeader_t* pMemory)
 {
 	int ret = 0;
-	if (!com_validateZone || !com_validateZone->integer)
+
+#ifdef DETAILED_ZONE_DEBUG_CODE
+	// this won't happen here, but wtf?
+	int& iAllocCount = mapAllocatedZones[pMemory];
+	if (iAllocCount <= 0)
 	{
+		Com_Error(ERR_FATAL, "Z_Validate(): Bad block allocation count!");
 		return ret;
 	}
+#endif
 
-	zoneHeader_t* pMemory = TheZone.Header.pNext;
-	while (pMemory)
+	if (pMemory->iMagic != ZONE_MAGIC)
 	{
-#ifdef DETAILED_ZONE_DEBUG_CODE
-		// this won't happen here, but wtf?
-		int& iAllocCount = mapAllocatedZones[pMemory];
-		if (iAllocCount <= 0)
+		Com_Error(ERR_FATAL, "Z_Validate(): Corrupt zone header!");
+	}
+
+	// this block of code is intended to make sure all of the data is paged in
+	if (pMemory->eTag != TAG_IMAGE_T
+		&& pMemory->eTag != TAG_MODEL_MD3
+		&& pMemory->eTag != TAG_MODEL_GLM
+		&& pMemory->eTag != TAG_MODEL_GLA)
+		//don't bother with disk caches as they've already been hit or will be thrown out next
+	{
+		auto memstart = reinterpret_cast<unsigned char*>(pMemory);
+		int totalSize = pMemory->iSize;
+		while (totalSize > 4096)
 		{
-			Com_Error(ERR_FATAL, "Z_Validate(): Bad block allocation count!");
-			return ret;
+			memstart += 4096;
+			ret += static_cast<int>(*memstart); // this fools the optimizer
+			totalSize -= 4096;
 		}
-#endif
+	}
+
+	if (ZoneTailFromHeader(pMemory)->iMagic != ZONE_MAGIC)
+	{
+		Com_Error(ERR_FATAL, "Z_Validate(): Corrupt zone tail!");
+	}
+
+	return ret;
+}
 
-		if (pMemory->iMagic != ZONE_MAGIC)
+// Checks the next iWindow blocks after wherever the last call got to, list first then the arenas, so that soak
+//	tests can leave validation on without paying for a full walk on every alloc...
+//
+static int Zone_ValidateIncremental(const int iWindow)
+{
+	int ret = 0;
+	int iChecked = 0;
+	qboolean bWrapped = qfalse;
+
+	while (iChecked < iWindow)
+	{
+		if (gpZoneValidateBlock)
 		{
-			Com_Error(ERR_FATAL, "Z_Validate(): Corrupt zone header!");
+			ret += Zone_ValidateBlock(gpZoneValidateBlock);
+			gpZoneValidateBlock = gpZoneValidateBlock->pNext;
+			iChecked++;
+			continue;
 		}
 
-		// this block of code is intended to make sure all of the data is paged in
-		if (pMemory->eTag != TAG_IMAGE_T
-			&& pMemory->eTag != TAG_MODEL_MD3
-			&& pMemory->eTag != TAG_MODEL_GLM
-			&& pMemory->eTag != TAG_MODEL_GLA)
-			//don't bother with disk caches as they've already been hit or will be thrown out next
+		if (giZoneValidateArenaTag < TAG_COUNT)
 		{
-			auto memstart = reinterpret_cast<unsigned char*>(pMemory);
-			int totalSize = pMemory->iSize;
-			while (totalSize > 4096)
+			const zoneArenaChunk_t* pChunk = gpZoneValidateChunk;
+			if (pChunk && giZoneValidateOffset < pChunk->iUsed)
 			{
-				memstart += 4096;
-				ret += static_cast<int>(*memstart); // this fools the optimizer
-				totalSize -= 4096;
+				const auto pMemory = reinterpret_cast<zoneHeader_t*>(reinterpret_cast<byte*>(gpZoneValidateChunk) +
+					ZONE_ARENA_CHUNK_HEADER_SIZE + giZoneValidateOffset);
+				giZoneValidateOffset += ZoneArenaStride(pMemory->iSize);
+				if (pMemory->iMagic != INT_ID('F', 'R', 'E', 'E'))
+				{
+					ret += Zone_ValidateBlock(pMemory);
+					iChecked++;
+				}
 			}
+			else if (pChunk)
+			{
+				gpZoneValidateChunk = pChunk->pNext;
+				giZoneValidateOffset = 0;
+			}
+			else if (++giZoneValidateArenaTag < TAG_COUNT)
+			{
+				gpZoneValidateChunk = ZoneArenas[giZoneValidateArenaTag].pChunks;
+				giZoneValidateOffset = 0;
+			}
+			continue;
 		}
 
-		if (ZoneTailFromHeader(pMemory)->iMagic != ZONE_MAGIC)
+		// end of a lap, go round again (but only once per call, in case there's less than iWindow blocks in total)
+		//
+		if (bWrapped)
 		{
-			Com_Error(ERR_FATAL, "Z_Validate(): Corrupt zone tail!");
+			break;
 		}
+		bWrapped = qtrue;
+		gpZoneValidateBlock = TheZone.Header.pNext;
+		giZoneValidateArenaTag = 0;
+		gpZoneValidateChunk = ZoneArenas[0].pChunks;
+		giZoneValidateOffset = 0;
+	}
+	return ret;
+}
+
+// Scans through the linked list of mallocs (and the tag arenas) and makes sure no data has been overwritten
+
+int Z_Validate()
+{
+	int ret = 0;
+	if (!com_validateZone || !com_validateZone->integer)
+	{
+		return ret;
+	}
 
+	if (com_validateZone->integer == 2)
+	{
+		return Zone_ValidateIncremental(Q_max(1, com_validateZoneWindow->integer));
+	}
+
+	zoneHeader_t* pMemory = TheZone.Header.pNext;
+	while (pMemory)
+	{
+		ret += Zone_ValidateBlock(pMemory);
 		pMemory = pMemory->pNext;
 	}
+
+	Zone_ForEachArenaBlock([&ret](zoneHeader_t* pArenaMemory)
+	{
+		ret += Zone_ValidateBlock(pArenaMemory);
+	});
+
 	return ret;
 }
 
@@ -181,12 +707,12 @@ using StaticMem_t = struct
 #pragma pack(pop)
 
 constexpr static StaticZeroMem_t gZeroMalloc =
-{ {ZONE_MAGIC, TAG_STATIC, 0, nullptr, nullptr}, {ZONE_MAGIC} };
+{ {ZONE_MAGIC, TAG_STATIC, 0, 0, nullptr, nullptr}, {ZONE_MAGIC} };
 
 #ifdef DEBUG_ZONE_ALLOCS
-#define DEF_STATIC(_char) {ZONE_MAGIC, TAG_STATIC,2,NULL,NULL, "<static>",0,"",0},{_char,'\0'},{ZONE_MAGIC}
+#define DEF_STATIC(_char) {ZONE_MAGIC, TAG_STATIC,2,0,NULL,NULL, "<static>",0,"",0},{_char,'\0'},{ZONE_MAGIC}
 #else
-#define DEF_STATIC(_char) {ZONE_MAGIC, TAG_STATIC,2,NULL,NULL			        },{_char,'\0'},{ZONE_MAGIC}
+#define DEF_STATIC(_char) {ZONE_MAGIC, TAG_STATIC,2,0,NULL,NULL			        },{_char,'\0'},{ZONE_MAGIC}
 #endif
 
 constexpr static StaticMem_t gEmptyString =
@@ -255,9 +781,26 @@ void* Z_Malloc(const int iSize, const memtag_t eTag, const qboolean bZeroit, con
 	//	int iRealSize = (iSize + sizeof(zoneHeader_t) + sizeof(zoneTail_t) + 3) & 0xfffffffc;
 	const int iRealSize = iSize + sizeof(zoneHeader_t) + sizeof(zoneTail_t);
 
-	// Allocate a chunk...
+	// Allocate a chunk...  (small ones come off the slabs if we can, else fall through to the usual malloc)
 	//
 	zoneHeader_t* pMemory = nullptr;
+	Zone_UpdateGuardTag();
+	if (eTag == giZoneGuardTag)
+	{
+		pMemory = Zone_GuardAlloc(iSize);
+	}
+	else if (ZoneArenas[eTag].bEnabled)
+	{
+		pMemory = Zone_ArenaAlloc(eTag, iSize, bZeroit);
+	}
+	else
+	{
+		const int iSlabClass = Zone_SlabClassForSize(iSize);
+		if (iSlabClass)
+		{
+			pMemory = Zone_SlabAlloc(iSlabClass, iRealSize, bZeroit);
+		}
+	}
 	while (pMemory == nullptr)
 	{
 		if (gbMemFreeupOccured)
@@ -273,7 +816,11 @@ void* Z_Malloc(const int iSize, const memtag_t eTag, const qboolean bZeroit, con
 		{
 			pMemory = static_cast<zoneHeader_t*>(malloc(iRealSize));
 		}
-		if (!pMemory)
+		if (pMemory)
+		{
+			pMemory->iSlabClass = 0;
+		}
+		else
 		{
 			// new bit, if we fail to malloc memory, try dumping some of the cached stuff that's non-vital and try again...
 			//
@@ -358,17 +905,20 @@ void* Z_Malloc(const int iSize, const memtag_t eTag, const qboolean bZeroit, con
 	pMemory->iSnapshotNumber = giZoneSnaphotNum;
 #endif
 
-	// Link in
+	// Link in  (arena blocks are owned by their chunk instead)
 	pMemory->iMagic = ZONE_MAGIC;
 	pMemory->eTag = eTag;
 	pMemory->iSize = iSize;
-	pMemory->pNext = TheZone.Header.pNext;
-	TheZone.Header.pNext = pMemory;
-	if (pMemory->pNext)
+	if (pMemory->iSlabClass != ZONE_ARENA_CLASS)
 	{
-		pMemory->pNext->pPrev = pMemory;
+		pMemory->pNext = TheZone.Header.pNext;
+		TheZone.Header.pNext = pMemory;
+		if (pMemory->pNext)
+		{
+			pMemory->pNext->pPrev = pMemory;
+		}
+		pMemory->pPrev = &TheZone.Header;
 	}
-	pMemory->pPrev = &TheZone.Header;
 	//
 	// add tail...
 	//
@@ -398,17 +948,37 @@ void* Z_Malloc(const int iSize, const memtag_t eTag, const qboolean bZeroit, con
 
 // Special wrapper around Z_Malloc for better separation between the main engine
 // code and the bundled minizip library.
+//
+// The zone isn't thread safe, so a thread other than the main one that opens its own minizip handles
+//	(the file system's prefetch workers) turns this on first and they come from plain malloc instead.
+//	It has to open, read and close them all on that same thread...
+//
+static thread_local qboolean gbMinizipMalloc = qfalse;
+
+void Z_MinizipThreadMalloc(const qboolean bMalloc)
+{
+	gbMinizipMalloc = bMalloc;
+}
 
 extern "C" Q_EXPORT void* openjk_minizip_malloc(int size);
 extern "C" Q_EXPORT int openjk_minizip_free(void* to_free);
 
 void* openjk_minizip_malloc(const int size)
 {
+	if (gbMinizipMalloc)
+	{
+		return malloc(size);
+	}
 	return Z_Malloc(size, TAG_MINIZIP, qfalse);
 }
 
 int openjk_minizip_free(void* to_free)
 {
+	if (gbMinizipMalloc)
+	{
+		free(to_free);
+		return 0;
+	}
 	return Z_Free(to_free);
 }
 
@@ -423,6 +993,11 @@ void Z_MorphMallocTag(void* pvAddress, const memtag_t eDesiredTag)
 	{
 		Com_Error(ERR_FATAL, "Z_MorphMallocTag(): Not a valid zone header!");
 	}
+	if (pMemory->iSlabClass == ZONE_ARENA_CLASS)
+	{
+		Com_Error(ERR_FATAL, "Z_MorphMallocTag(): Can't morph a block out of the TAG_%s arena!",
+			psTagStrings[pMemory->eTag]);
+	}
 
 	// DEC existing tag stats...
 	//
@@ -455,6 +1030,12 @@ static int Zone_FreeBlock(zoneHeader_t* pMemory)
 		TheZone.Stats.iSizesPerTag[pMemory->eTag] -= pMemory->iSize;
 		TheZone.Stats.iCountsPerTag[pMemory->eTag]--;
 
+		if (pMemory->iSlabClass == ZONE_ARENA_CLASS)
+		{
+			Zone_ArenaFreeBlock(pMemory);
+			return iSize;
+		}
+
 		// Sanity checks...
 		//
 		assert(pMemory->pPrev->pNext == pMemory);
@@ -462,6 +1043,7 @@ static int Zone_FreeBlock(zoneHeader_t* pMemory)
 
 		// Unlink and free...
 		//
+		Zone_ValidateBlockGone(pMemory);
 		pMemory->pPrev->pNext = pMemory->pNext;
 		if (pMemory->pNext)
 		{
@@ -470,7 +1052,18 @@ static int Zone_FreeBlock(zoneHeader_t* pMemory)
 
 		//debugging double frees
 		pMemory->iMagic = INT_ID('F', 'R', 'E', 'E');
-		free(pMemory);
+		if (pMemory->iSlabClass == ZONE_GUARD_CLASS)
+		{
+			Zone_GuardFree(pMemory);
+		}
+		else if (pMemory->iSlabClass)
+		{
+			Zone_SlabFree(pMemory);
+		}
+		else
+		{
+			free(pMemory);
+		}
 
 #ifdef DETAILED_ZONE_DEBUG_CODE
 		// this has already been checked for in execution order, but wtf?
@@ -613,6 +1206,26 @@ void Z_TagFree(const memtag_t eTag)
 	//	int iZoneBlocks = TheZone.Stats.iCount;
 	//#endif
 
+	if (eTag == TAG_ALL)
+	{
+		for (int i = 0; i < TAG_COUNT; i++)
+		{
+			Zone_ArenaTagFree(static_cast<memtag_t>(i));
+		}
+	}
+	else
+	{
+		Zone_ArenaTagFree(eTag);
+
+		// anything left must be ordinary blocks (eg the arena was off or out of mem when they were alloc'd),
+		//	so don't bother walking the whole zone if there aren't any...
+		//
+		if (!TheZone.Stats.iCountsPerTag[eTag])
+		{
+			return;
+		}
+	}
+
 	zoneHeader_t* pMemory = TheZone.Header.pNext;
 	while (pMemory)
 	{
@@ -678,6 +1291,37 @@ static void Z_Stats_f()
 		TheZone.Stats.iPeak,
 		static_cast<float>(TheZone.Stats.iPeak) / 1024.0f / 1024.0f
 	);
+
+	int iSlabBlocks = 0;
+	int iSlabFree = 0;
+	for (const auto& slabClass : ZoneSlabClasses)
+	{
+		iSlabBlocks += slabClass.iBlocksTotal;
+		iSlabFree += slabClass.iBlocksFree;
+	}
+	Com_Printf("Small-block slabs: %d pages (%.2fMB), %d blocks in use, %d free, limit %d bytes\n",
+		giZoneSlabPageCount,
+		static_cast<float>(giZoneSlabPageCount) * ZONE_SLAB_PAGE_SIZE / 1024.0f / 1024.0f,
+		iSlabBlocks - iSlabFree,
+		iSlabFree,
+		com_zoneSlabMax ? com_zoneSlabMax->integer : atoi(ZONE_SLAB_MAX_DEFAULT)
+	);
+
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		const zoneArena_t& arena = ZoneArenas[i];
+		if (arena.bEnabled || arena.iChunkCount)
+		{
+			Com_Printf("%20s arena: %d chunks (%.2fMB), %d bytes live in %d blocks%s\n",
+				psTagStrings[i],
+				arena.iChunkCount,
+				static_cast<float>(arena.iChunkBytes) / 1024.0f / 1024.0f,
+				arena.iLiveBytes,
+				arena.iLiveCount,
+				arena.bEnabled ? "" : " (disabled)"
+			);
+		}
+	}
 }
 
 // Gives a detailed breakdown of the memory blocks in the zone
@@ -891,6 +1535,13 @@ void Com_ShutdownZoneMemory()
 				abs(TheZone.Stats.iCount), abs(TheZone.Stats.iCurrent));
 		}
 	}
+
+	for (int i = 0; i < TAG_COUNT; i++)
+	{
+		Zone_ArenaTagFree(static_cast<memtag_t>(i)); // chunks that only have dead blocks left in them
+		ZoneArenas[i].bEnabled = qfalse;
+	}
+	Zone_SlabShutdown();
 }
 
 // Initialises the zone memory system
@@ -906,6 +1557,24 @@ void Com_InitZoneMemory()
 void Com_InitZoneMemoryVars()
 {
 	com_validateZone = Cvar_Get("com_validateZone", "0", 0);
+	com_validateZoneWindow = Cvar_Get("com_validateZoneWindow", "64", 0);
+	com_zoneGuardTag = Cvar_Get("com_zoneGuardTag", "", 0);
+	com_zoneGuardTag->modified = qtrue;
+	com_zoneSlabMax = Cvar_Get("com_zoneSlabMax", ZONE_SLAB_MAX_DEFAULT, CVAR_ARCHIVE_ND);
+
+#ifdef ZONE_ARENAS
+	// opt-in from the command line only ("+set com_zoneArenas 1"), this runs before any config gets exec'd.
+	//	Nothing has been allocated under these tags yet so there's nothing to move across...
+	//
+	Com_StartupVariable("com_zoneArenas");
+	if (Cvar_Get("com_zoneArenas", "0", CVAR_INIT)->integer)
+	{
+		for (const memtag_t eTag : ZoneArenaDefaultTags)
+		{
+			ZoneArenas[eTag].bEnabled = qtrue;
+		}
+	}
+#endif
 
 	Cmd_AddCommand("zone_stats", Z_Stats_f);
 	Cmd_AddCommand("zone_details", Z_Details_f);
@@ -979,6 +1648,17 @@ void Com_TouchMemory()
 		pMemory = pMemory->pNext;
 	}
 
+	Zone_ForEachArenaBlock([&](const zoneHeader_t* pArenaMemory)
+	{
+		const auto pMem = reinterpret_cast<const int*>(&pArenaMemory[1]);
+		const int j = pArenaMemory->iSize >> 2;
+		for (int i = 0; i < j; i += 64)
+		{
+			sum += pMem[i];
+		}
+		totalTouched += pArenaMemory->iSize;
+	});
+
 	//end = Sys_Milliseconds();
 
 	//Com_Printf( "Com_TouchMemory: %i bytes, %i msec\n", totalTouched, end - start );
@@ -866,6 +866,7 @@ qboolean G2API_SetSurfaceOnOff(CGhoul2Info* ghlInfo, const char* surfaceName, co
 		G2ERROR(!(flags & ~(G2SURFACEFLAG_OFF | G2SURFACEFLAG_NODESCENDANTS)), "G2API_SetSurfaceOnOff Illegal Flags");
 		// ensure we flush the cache
 		ghlInfo->mMeshFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		return G2_SetSurfaceOnOff(ghlInfo, surfaceName, flags);
 	}
 	return qfalse;
@@ -880,6 +881,7 @@ qboolean G2API_SetRootSurface(CGhoul2Info_v& ghlInfo, const int modelIndex, cons
 		G2ERROR(modelIndex >= 0 && modelIndex < ghlInfo.size(), "Bad Model Index");
 		if (modelIndex >= 0 && modelIndex < ghlInfo.size())
 		{
+			G2_InvalidateBoltCache(&ghlInfo[modelIndex]);
 			return G2_SetRootSurface(ghlInfo, modelIndex, surfaceName);
 		}
 	}
@@ -892,6 +894,7 @@ int G2API_AddSurface(CGhoul2Info* ghlInfo, const int surface_number, const int p
 	{
 		// ensure we flush the cache
 		ghlInfo->mMeshFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		return G2_AddSurface(ghlInfo, surface_number, poly_number, barycentric_i, barycentric_j, lod);
 	}
 	return -1;
@@ -903,6 +906,7 @@ qboolean G2API_RemoveSurface(CGhoul2Info* ghlInfo, const int index)
 	{
 		// ensure we flush the cache
 		ghlInfo->mMeshFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		return G2_RemoveSurface(ghlInfo->mSlist, index);
 	}
 	return qfalse;
@@ -1030,6 +1034,7 @@ qboolean G2API_SetBoneAnimIndex(CGhoul2Info* ghlInfo, const int index, const int
 			*const_cast<float*>(&set_frame) = 0.0f;
 		}
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ERROR(index >= 0 && index < (int)ghlInfo->mBlist.size(), va("Out of Range Bone Index (%s)", ghlInfo->mFileName));
 		if (index >= 0 && index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
@@ -1075,6 +1080,7 @@ qboolean G2API_SetBoneAnim(CGhoul2Info* ghlInfo, const char* boneName, const int
 			*const_cast<float*>(&set_frame) = 0.0f;
 		}
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		const int current_time = G2API_GetTime(acurrent_time);
 		ret = G2_Set_Bone_Anim(ghlInfo, ghlInfo->mBlist, boneName, startFrame, endFrame, flags, anim_speed, current_time, set_frame, blend_time);
 		G2ANIM(ghlInfo, "G2API_SetBoneAnim");
@@ -1192,6 +1198,7 @@ qboolean G2API_PauseBoneAnim(CGhoul2Info* ghlInfo, const char* boneName, const i
 	{
 		const int current_time = G2API_GetTime(acurrent_time);
 		ret = G2_Pause_Bone_Anim(ghlInfo, ghlInfo->mBlist, boneName, current_time);
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ANIM(ghlInfo, "G2API_PauseBoneAnim");
 	}
 	G2NOTE(ret, "G2API_PauseBoneAnim Failed");
@@ -1208,6 +1215,7 @@ qboolean G2API_PauseBoneAnimIndex(CGhoul2Info* ghlInfo, const int bone_index, co
 		if (bone_index >= 0 && bone_index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
 			ret = G2_Pause_Bone_Anim_Index(ghlInfo->mBlist, bone_index, current_time, ghlInfo->aHeader->numFrames);
+			G2_InvalidateBoltCache(ghlInfo);
 			G2ANIM(ghlInfo, "G2API_PauseBoneAnimIndex");
 		}
 	}
@@ -1237,6 +1245,7 @@ qboolean G2API_StopBoneAnimIndex(CGhoul2Info* ghlInfo, const int index)
 		if (index >= 0 && index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
 			ret = G2_Stop_Bone_Anim_Index(ghlInfo->mBlist, index);
+			G2_InvalidateBoltCache(ghlInfo);
 			G2ANIM(ghlInfo, "G2API_StopBoneAnimIndex");
 		}
 	}
@@ -1251,6 +1260,7 @@ qboolean G2API_StopBoneAnim(CGhoul2Info* ghlInfo, const char* boneName)
 	if (boneName && G2_SetupModelPointers(ghlInfo))
 	{
 		ret = G2_Stop_Bone_Anim(ghlInfo, ghlInfo->mBlist, boneName);
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ANIM(ghlInfo, "G2API_StopBoneAnim");
 	}
 	G2WARNING(ret, "G2API_StopBoneAnim Failed");
@@ -1272,6 +1282,7 @@ static qboolean G2API_SetBoneAnglesOffsetIndex(CGhoul2Info* ghlInfo, const int i
 		const int current_time = G2API_GetTime(acurrent_time);
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ERROR(index >= 0 && index < (int)ghlInfo->mBlist.size(), "G2API_SetBoneAnglesIndex:Invalid bone index");
 		if (index >= 0 && index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
@@ -1303,6 +1314,7 @@ qboolean G2API_SetBoneAnglesOffset(CGhoul2Info* ghlInfo, const char* boneName, c
 		const int current_time = G2API_GetTime(acurrent_time);
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		ret = G2_Set_Bone_Angles(ghlInfo, ghlInfo->mBlist, boneName, angles, flags, up, left, forward, blend_time, current_time, offset);
 	}
 	G2WARNING(ret, "G2API_SetBoneAngles Failed");
@@ -1322,6 +1334,7 @@ qboolean G2API_SetBoneAnglesMatrixIndex(CGhoul2Info* ghlInfo, const int index, c
 		const int current_time = G2API_GetTime(acurrent_time);
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ERROR(index >= 0 && index < (int)ghlInfo->mBlist.size(), "Bad Bone Index");
 		if (index >= 0 && index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
@@ -1341,6 +1354,7 @@ qboolean G2API_SetBoneAnglesMatrix(CGhoul2Info* ghlInfo, const char* boneName, c
 		const int current_time = G2API_GetTime(acurrent_time);
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		ret = G2_Set_Bone_Angles_Matrix(ghlInfo, ghlInfo->mBlist, boneName, matrix, flags, blend_time, current_time);
 	}
 	G2WARNING(ret, "G2API_SetBoneAnglesMatrix Failed");
@@ -1354,6 +1368,7 @@ qboolean G2API_StopBoneAnglesIndex(CGhoul2Info* ghlInfo, const int index)
 	{
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		G2ERROR(index >= 0 && index < (int)ghlInfo->mBlist.size(), "Bad Bone Index");
 		if (index >= 0 && index < static_cast<int>(ghlInfo->mBlist.size()))
 		{
@@ -1372,6 +1387,7 @@ qboolean G2API_StopBoneAngles(CGhoul2Info* ghlInfo, const char* boneName)
 	{
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		ret = G2_Stop_Bone_Angles(ghlInfo, ghlInfo->mBlist, boneName);
 	}
 	G2WARNING(ret, "G2API_StopBoneAngles Failed");
@@ -1383,6 +1399,7 @@ class CRagDollParams;
 void G2_SetRagDoll(CGhoul2Info_v& ghoul2V, CRagDollParams* parms);
 void G2API_SetRagDoll(CGhoul2Info_v& ghoul2, CRagDollParams* parms)
 {
+	G2_InvalidateBoltCache(ghoul2);
 	G2_SetRagDoll(ghoul2, parms);
 }
 //rww - RAGDOLL_END
@@ -1395,6 +1412,7 @@ qboolean G2API_RemoveBone(CGhoul2Info* ghlInfo, const char* boneName)
 	{
 		// ensure we flush the cache
 		ghlInfo->mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		ret = G2_Remove_Bone(ghlInfo, ghlInfo->mBlist, boneName);
 		G2ANIM(ghlInfo, "G2API_RemoveBone");
 	}
@@ -1425,6 +1443,7 @@ void G2API_AnimateG2Models(CGhoul2Info_v& ghoul2, const int acurrent_time, CRagD
 		if (ghoul2[model].mModel)
 		{
 			G2_Animate_Bone_List(ghoul2, current_time, model, params);
+			G2_InvalidateBoltCache(&ghoul2[model]);
 		}
 	}
 #ifdef _DEBUG
@@ -1584,6 +1603,7 @@ qboolean G2_SetBoneIKState(CGhoul2Info_v& ghoul2, const int time, const char* bo
 
 qboolean G2API_SetBoneIKState(CGhoul2Info_v& ghoul2, const int time, const char* boneName, const int ikState, sharedSetBoneIKStateParams_t* params)
 {
+	G2_InvalidateBoltCache(ghoul2);
 	return G2_SetBoneIKState(ghoul2, time, boneName, ikState, params);
 }
 
@@ -1591,6 +1611,7 @@ qboolean G2_IKMove(CGhoul2Info_v& ghoul2, int time, sharedIKMoveParams_t* params
 
 qboolean G2API_IKMove(CGhoul2Info_v& ghoul2, const int time, sharedIKMoveParams_t* params)
 {
+	G2_InvalidateBoltCache(ghoul2);
 	return G2_IKMove(ghoul2, time, params);
 }
 
@@ -1600,6 +1621,7 @@ qboolean G2API_RemoveBolt(CGhoul2Info* ghlInfo, const int index)
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		ret = G2_Remove_Bolt(ghlInfo->mBltlist, index);
+		G2_InvalidateBoltCache(ghlInfo);
 	}
 	G2WARNING(ret, "G2API_RemoveBolt Failed");
 	return ret;
@@ -1612,6 +1634,7 @@ int G2API_AddBolt(CGhoul2Info* ghlInfo, const char* boneName)
 	if (boneName && G2_SetupModelPointers(ghlInfo))
 	{
 		ret = G2_Add_Bolt(ghlInfo, ghlInfo->mBltlist, ghlInfo->mSlist, boneName);
+		G2_InvalidateBoltCache(ghlInfo);
 		G2NOTE(ret >= 0, va("G2API_AddBolt Failed (%s:%s)", boneName, ghlInfo->mFileName));
 	}
 	return ret;
@@ -1623,6 +1646,7 @@ int G2API_AddBoltSurfNum(CGhoul2Info* ghlInfo, const int surf_index)
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		ret = G2_Add_Bolt_Surf_Num(ghlInfo, ghlInfo->mBltlist, ghlInfo->mSlist, surf_index);
+		G2_InvalidateBoltCache(ghlInfo);
 	}
 	G2WARNING(ret >= 0, "G2API_AddBoltSurfNum Failed");
 	return ret;
@@ -1726,24 +1750,7 @@ qboolean G2API_GetBoltMatrix(CGhoul2Info_v& ghoul2, const int modelIndex, const
 					G2_ConstructGhoulSkeleton(ghoul2, frameNum, true, scale);
 				}
 
-				G2_GetBoltMatrixLow(*ghlInfo, bolt_index, scale, bolt);
-				// scale the bolt position by the scale factor for this model since at this point its still in model space
-				if (scale[0])
-				{
-					bolt.matrix[0][3] *= scale[0];
-				}
-				if (scale[1])
-				{
-					bolt.matrix[1][3] *= scale[1];
-				}
-				if (scale[2])
-				{
-					bolt.matrix[2][3] *= scale[2];
-				}
-				VectorNormalize(reinterpret_cast<float*>(&bolt.matrix[0]));
-				VectorNormalize(reinterpret_cast<float*>(&bolt.matrix[1]));
-				VectorNormalize(reinterpret_cast<float*>(&bolt.matrix[2]));
-
+				G2_GetBoltMatrixCached(*ghlInfo, bolt_index, scale, bolt);
 				Multiply_3x4Matrix(matrix, &worldMatrix, &bolt);
 #if G2API_DEBUG
 				for (int i = 0; i < 3; i++)
@@ -1864,6 +1871,8 @@ static int QDECL QsortDistance(const void* a, const void* b) {
 	return 1;
 }
 
+void G2_TransformModelForTrace(CGhoul2Info_v& ghoul2, int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, const vec3_t rayStart, const vec3_t rayEnd, float fRadius);
+
 void G2API_CollisionDetect(CCollisionRecord* coll_rec_map, CGhoul2Info_v& ghoul2, const vec3_t angles, const vec3_t position, const int aframe_number, int entNum, vec3_t ray_start, vec3_t ray_end, vec3_t scale, CMiniHeap* G2VertSpace, EG2_Collision eG2TraceType, int useLod, float f_radius)
 {
 	G2ERROR(ghoul2.IsValid(), "Invalid ghlInfo");
@@ -1882,18 +1891,14 @@ void G2API_CollisionDetect(CCollisionRecord* coll_rec_map, CGhoul2Info_v& ghoul2
 
 		ri.GetG2VertSpaceServer()->ResetHeap();
 
-		// now having done that, time to build the model
-#ifdef _G2_GORE
-		G2_TransformModel(ghoul2, frame_number, scale, ri.GetG2VertSpaceServer(), useLod, false);
-#else
-		G2_TransformModel(ghoul2, frameNumber, scale, ri.GetG2VertSpaceServer(), useLod);
-#endif
-
-		// model is built. Lets check to see if any triangles are actually hit.
-		// first up, translate the ray to model space
+		// translate the ray to model space
 		TransformAndTranslatePoint(ray_start, trans_ray_start, &worldMatrixInv);
 		TransformAndTranslatePoint(ray_end, trans_ray_end, &worldMatrixInv);
 
+		// now having done that, time to build the model - only the surfaces the ray might hit
+		G2_TransformModelForTrace(ghoul2, frame_number, scale, ri.GetG2VertSpaceServer(), useLod, trans_ray_start, trans_ray_end, f_radius);
+
+		// model is built. Lets check to see if any triangles are actually hit.
 		// now walk each model and check the ray against each poly - sigh, this is SO expensive. I wish there was a better way to do this.
 #ifdef _G2_GORE
 		G2_TraceModels(ghoul2, trans_ray_start, trans_ray_end, coll_rec_map, entNum, eG2TraceType, useLod, f_radius, 0, 0, 0, 0, nullptr, qfalse);
@@ -45,36 +45,137 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 //rww - RAGDOLL_END
 
 extern cvar_t* r_Ghoul2BlendMultiplier;
+extern cvar_t* r_Ghoul2BoneHash;
 
 void G2_Bone_Not_Found(const char* boneName);
 
 //=====================================================================================================================
 // Bone List handling routines - so entities can override bone info on a bone by bone level, and also interrogate this info
 
-// Given a bone name, see if that bone is already in our bone list - note the model_t pointer that gets passed in here MUST point at the
-// gla file, not the glm file type.
-int G2_Find_Bone(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const char* boneName)
+static unsigned G2_Bone_Name_Hash(const char* boneName)
 {
-	const mdxaSkelOffsets_t* offsets = reinterpret_cast<mdxaSkelOffsets_t*>((byte*)ghlInfo->aHeader + sizeof(mdxaHeader_t));
+	unsigned hash = 0;
+	for (; *boneName; boneName++)
+	{
+		hash = hash * 31 + tolower(static_cast<unsigned char>(*boneName));
+	}
+	return hash;
+}
 
-	// look through entire list
-	for (size_t i = 0; i < blist.size(); i++)
+static const mdxaSkel_t* G2_Skel_Bone(const mdxaHeader_t* header, const int bone_num)
+{
+	const mdxaSkelOffsets_t* offsets = reinterpret_cast<const mdxaSkelOffsets_t*>(reinterpret_cast<const byte*>(header) + sizeof(mdxaHeader_t));
+	return reinterpret_cast<const mdxaSkel_t*>(reinterpret_cast<const byte*>(header) + sizeof(mdxaHeader_t) + offsets->offsets[bone_num]);
+}
+
+// hash the bone names of a gla that has just been loaded
+void G2_Build_Bone_Name_Hash(model_t* mod)
+{
+	const mdxaHeader_t* mdxa = mod->mdxa;
+
+	int size = 16;
+	while (size < mdxa->numBones * 2)
 	{
-		// if this bone entry has no info in it, bounce over it
-		if (blist[i].boneNumber == -1)
+		size <<= 1;
+	}
+
+	mdxaBoneHash_t* hash = static_cast<mdxaBoneHash_t*>(R_Hunk_Alloc(sizeof(mdxaBoneHash_t) + (size - 1) * sizeof(short), qfalse));
+	hash->mask = size - 1;
+	for (int i = 0; i < size; i++)
+	{
+		hash->bones[i] = -1;
+	}
+
+	// in skeleton order, so with duplicate names the first bone is found first, as it was by a walk down the skeleton
+	for (int x = 0; x < mdxa->numBones; x++)
+	{
+		unsigned i = G2_Bone_Name_Hash(G2_Skel_Bone(mdxa, x)->name) & hash->mask;
+		while (hash->bones[i] != -1)
 		{
-			continue;
+			i = i + 1 & hash->mask;
 		}
+		hash->bones[i] = x;
+	}
 
-		// figure out what skeletal info structure this bone entry is looking at
-		const mdxaSkel_t* skel = reinterpret_cast<mdxaSkel_t*>((byte*)ghlInfo->aHeader + sizeof(mdxaHeader_t) + offsets->offsets[blist[
-			i].
-			boneNumber]);
+	mod->mdxaBoneHash = hash;
+}
 
-		// if name is the same, we found it
-		if (!Q_stricmp(skel->name, boneName))
+// Given a bone name, find that bone in the skeleton of the gla - or -1 if it isn't there
+int G2_Find_Skel_Bone(const model_t* mod, const char* boneName)
+{
+	const mdxaBoneHash_t* hash = mod->mdxaBoneHash;
+
+	if (!hash || !r_Ghoul2BoneHash->integer)
+	{
+		// walk the entire list of bones in the gla file for this model and see if any match the name of the bone we want to find
+		for (int x = 0; x < mod->mdxa->numBones; x++)
 		{
-			return i;
+			if (!Q_stricmp(G2_Skel_Bone(mod->mdxa, x)->name, boneName))
+			{
+				return x;
+			}
+		}
+		return -1;
+	}
+
+	for (unsigned i = G2_Bone_Name_Hash(boneName) & hash->mask; hash->bones[i] != -1; i = i + 1 & hash->mask)
+	{
+		if (!Q_stricmp(G2_Skel_Bone(mod->mdxa, hash->bones[i])->name, boneName))
+		{
+			return hash->bones[i];
+		}
+	}
+	return -1;
+}
+
+static void G2_Set_Bone_Slot(const CGhoul2Info* ghlInfo, const int bone_num, const int index)
+{
+	std::vector<short>& slots = ghlInfo->mBoneSlots;
+	if (bone_num >= static_cast<int>(slots.size()))
+	{
+		slots.resize(Q_max(bone_num + 1, ghlInfo->animModel->mdxa->numBones), -1);
+	}
+	slots[bone_num] = index;
+}
+
+// Given a skeleton bone, find its entry in the bone list. mBoneSlots remembers where each one was last found or added,
+// but the list gets changed behind its back (bones removed, save games loaded) so a slot is only believed if it still
+// holds the bone. Add_Bone always records the first entry for a bone, so the remembered one is the one a walk would find
+int G2_Find_Bone_Slot(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const int bone_num)
+{
+	if (&blist != &ghlInfo->mBlist || !r_Ghoul2BoneHash->integer)
+	{
+		return G2_Find_Bone_In_List(blist, bone_num);
+	}
+
+	const std::vector<short>& slots = ghlInfo->mBoneSlots;
+	if (bone_num < static_cast<int>(slots.size()))
+	{
+		const int index = slots[bone_num];
+		if (index >= 0 && index < static_cast<int>(blist.size()) && blist[index].boneNumber == bone_num)
+		{
+			return index;
+		}
+	}
+
+	const int index = G2_Find_Bone_In_List(blist, bone_num);
+	if (index != -1)
+	{
+		G2_Set_Bone_Slot(ghlInfo, bone_num, index);
+	}
+	return index;
+}
+
+// Given a bone name, see if that bone is already in our bone list
+int G2_Find_Bone(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const char* boneName)
+{
+	const int bone_num = G2_Find_Skel_Bone(ghlInfo->animModel, boneName);
+	if (bone_num != -1)
+	{
+		const int index = G2_Find_Bone_Slot(ghlInfo, blist, bone_num);
+		if (index != -1)
+		{
+			return index;
 		}
 	}
 #if _DEBUG
@@ -87,31 +188,17 @@ int G2_Find_Bone(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const char
 #define DEBUG_G2_BONES (0)
 
 // we need to add a bone to the list - find a free one and see if we can find a corresponding bone in the gla file
-int G2_Add_Bone(const model_t* mod, boneInfo_v& blist, const char* boneName)
+int G2_Add_Bone(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const char* boneName)
 {
-	mdxaSkel_t* skel;
 	boneInfo_t temp_bone;
 
 	//rww - RAGDOLL_BEGIN
 	memset(&temp_bone, 0, sizeof temp_bone);
 	//rww - RAGDOLL_END
 
-	const mdxaSkelOffsets_t* offsets = reinterpret_cast<mdxaSkelOffsets_t*>(reinterpret_cast<byte*>(mod->mdxa) + sizeof(mdxaHeader_t));
-
-	// walk the entire list of bones in the gla file for this model and see if any match the name of the bone we want to find
-	int x;
-	for (x = 0; x < mod->mdxa->numBones; x++)
-	{
-		skel = reinterpret_cast<mdxaSkel_t*>(reinterpret_cast<byte*>(mod->mdxa) + sizeof(mdxaHeader_t) + offsets->offsets[x]);
-		// if name is the same, we found it
-		if (!Q_stricmp(skel->name, boneName))
-		{
-			break;
-		}
-	}
-
-	// check to see we did actually make a match with a bone in the model
-	if (x == mod->mdxa->numBones)
+	// check to see we can actually make a match with a bone in the model
+	const int x = G2_Find_Skel_Bone(ghlInfo->animModel, boneName);
+	if (x == -1)
 	{
 #if _DEBUG
 		G2_Bone_Not_Found(boneName);
@@ -119,34 +206,20 @@ int G2_Add_Bone(const model_t* mod, boneInfo_v& blist, const char* boneName)
 		return -1;
 	}
 
-	// look through entire list - see if it's already there first
-	for (size_t i = 0; i < blist.size(); i++)
+	// see if it's already there first - though an empty slot ahead of it gets used instead, as it always has
+	const int existing = G2_Find_Bone_Slot(ghlInfo, blist, x);
+	const int end = existing == -1 ? static_cast<int>(blist.size()) : existing;
+	for (int i = 0; i < end; i++)
 	{
-		// if this bone entry has info in it, bounce over it
-		if (blist[i].boneNumber != -1)
-		{
-			skel = reinterpret_cast<mdxaSkel_t*>(reinterpret_cast<byte*>(mod->mdxa) + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
-			// if name is the same, we found it
-			if (!Q_stricmp(skel->name, boneName))
-			{
-#if DEBUG_G2_BONES
-				{
-					char mess[1000];
-					sprintf(mess, "ADD BONE1 blistIndex=%3d    physicalIndex=%3d   %s\n",
-						i,
-						x,
-						boneName);
-					OutputDebugString(mess);
-				}
-#endif
-				return i;
-			}
-		}
-		else
+		// if we found an entry that had a -1 for the bonenumber, then we hit a bone slot that was empty
+		if (blist[i].boneNumber == -1)
 		{
-			// if we found an entry that had a -1 for the bonenumber, then we hit a bone slot that was empty
 			blist[i].boneNumber = x;
 			blist[i].flags = 0;
+			if (&blist == &ghlInfo->mBlist)
+			{
+				G2_Set_Bone_Slot(ghlInfo, x, i);
+			}
 #if DEBUG_G2_BONES
 			{
 				char mess[1000];
@@ -161,10 +234,29 @@ int G2_Add_Bone(const model_t* mod, boneInfo_v& blist, const char* boneName)
 		}
 	}
 
+	if (existing != -1)
+	{
+#if DEBUG_G2_BONES
+		{
+			char mess[1000];
+			sprintf(mess, "ADD BONE1 blistIndex=%3d    physicalIndex=%3d   %s\n",
+				existing,
+				x,
+				boneName);
+			OutputDebugString(mess);
+		}
+#endif
+		return existing;
+	}
+
 	// ok, we didn't find an existing bone of that name, or an empty slot. Lets add an entry
 	temp_bone.boneNumber = x;
 	temp_bone.flags = 0;
 	blist.push_back(temp_bone);
+	if (&blist == &ghlInfo->mBlist)
+	{
+		G2_Set_Bone_Slot(ghlInfo, x, blist.size() - 1);
+	}
 #if DEBUG_G2_BONES
 	{
 		char mess[1000];
@@ -479,7 +571,7 @@ qboolean G2_Set_Bone_Angles(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const
 	int index = G2_Find_Bone(ghlInfo, blist, boneName);
 	if (index == -1)
 	{
-		index = G2_Add_Bone(ghlInfo->animModel, blist, boneName);
+		index = G2_Add_Bone(ghlInfo, blist, boneName);
 	}
 	if (index != -1)
 	{
@@ -520,7 +612,7 @@ qboolean G2_Set_Bone_Angles_Matrix(const CGhoul2Info* ghlInfo, boneInfo_v& blist
 	int	index = G2_Find_Bone(ghlInfo, blist, boneName);
 	if (index == -1)
 	{
-		index = G2_Add_Bone(ghlInfo->animModel, blist, boneName);
+		index = G2_Add_Bone(ghlInfo, blist, boneName);
 	}
 	if (index != -1)
 	{
@@ -726,7 +818,7 @@ qboolean G2_Set_Bone_Anim(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const c
 			blend_time, ghlInfo->aHeader->numFrames);
 	}
 	// no - lets try and add this bone in
-	index = G2_Add_Bone(ghlInfo->animModel, blist, boneName);
+	index = G2_Add_Bone(ghlInfo, blist, boneName);
 
 	// did we find a free one?
 	if (index != -1)
@@ -1146,25 +1238,10 @@ static void G2_Generate_MatrixRag(boneInfo_v& blist, const int index)
 
 int G2_Find_Bone_Rag(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const char* boneName)
 {
-	const mdxaSkelOffsets_t* offsets = reinterpret_cast<mdxaSkelOffsets_t*>((byte*)ghlInfo->aHeader + sizeof(mdxaHeader_t));
-
-	// look through entire list
-	for (size_t i = 0; i < blist.size(); i++)
+	const int bone_num = G2_Find_Skel_Bone(ghlInfo->animModel, boneName);
+	if (bone_num != -1)
 	{
-		// if this bone entry has no info in it, bounce over it
-		if (blist[i].boneNumber == -1)
-		{
-			continue;
-		}
-
-		// figure out what skeletal info structure this bone entry is looking at
-		const mdxaSkel_t* skel = reinterpret_cast<mdxaSkel_t*>((byte*)ghlInfo->aHeader + sizeof(mdxaHeader_t) + offsets->offsets[blist[i].boneNumber]);
-
-		// if name is the same, we found it
-		if (!Q_stricmp(skel->name, boneName))
-		{
-			return i;
-		}
+		return G2_Find_Bone_Slot(ghlInfo, blist, bone_num);
 	}
 #if _DEBUG
 	//	G2_Bone_Not_Found(boneName,ghlInfo->mFileName);
@@ -1180,7 +1257,7 @@ static int G2_Set_Bone_Rag(boneInfo_v& blist, const char* boneName, const CGhoul
 
 	if (index == -1)
 	{
-		index = G2_Add_Bone(ghoul2.animModel, blist, boneName);
+		index = G2_Add_Bone(&ghoul2, blist, boneName);
 	}
 
 	if (index != -1)
@@ -1206,7 +1283,7 @@ static int G2_Set_Bone_Angles_Rag(const CGhoul2Info& ghoul2, boneInfo_v& blist,
 
 	if (index == -1)
 	{
-		index = G2_Add_Bone(ghoul2.animModel, blist, boneName);
+		index = G2_Add_Bone(&ghoul2, blist, boneName);
 	}
 	if (index != -1)
 	{
@@ -1379,7 +1456,7 @@ static qboolean G2_Set_Bone_Anim_No_BS(const CGhoul2Info& ghoul2, const mdxaHead
 		return qtrue;
 	}
 
-	index = G2_Add_Bone(ghoul2.animModel, blist, boneName);
+	index = G2_Add_Bone(&ghoul2, blist, boneName);
 
 	if (index != -1)
 	{
@@ -4258,7 +4335,7 @@ static int G2_Set_Bone_Angles_IK(const CGhoul2Info& ghoul2, boneInfo_v& blist, c
 
 	if (index == -1)
 	{
-		index = G2_Add_Bone(ghoul2.animModel, blist, boneName);
+		index = G2_Add_Bone(&ghoul2, blist, boneName);
 	}
 	if (index != -1)
 	{
@@ -4432,7 +4509,7 @@ qboolean G2_SetBoneIKState(CGhoul2Info_v& ghoul2, const int time, const char* bo
 
 	if (index == -1)
 	{
-		index = G2_Add_Bone(mod_a, blist, boneName);
+		index = G2_Add_Bone(&g2, blist, boneName);
 	}
 
 	if (index == -1)
@@ -4602,7 +4679,7 @@ int G2_Get_Bone_Index(CGhoul2Info* ghoul2, const char* boneName, const qboolean
 {
 	if (bAddIfNotFound)
 	{
-		return G2_Add_Bone(ghoul2->animModel, ghoul2->mBlist, boneName);
+		return G2_Add_Bone(ghoul2, ghoul2->mBlist, boneName);
 	}
 	return G2_Find_Bone(ghoul2, ghoul2->mBlist, boneName);
 }
@@ -407,7 +407,7 @@ int G2_DecideTraceLod(CGhoul2Info& ghoul2, int useLod)
 	return returnLod;
 }
 
-static void R_TransformEachSurface(const mdxmSurface_t* surface, vec3_t scale, CMiniHeap* G2VertSpace, intptr_t* TransformedVertsArray, CBoneCache* boneCache)
+static void R_TransformEachSurface(const model_t* currentModel, const mdxmSurface_t* surface, vec3_t scale, CMiniHeap* G2VertSpace, intptr_t* TransformedVertsArray, CBoneCache* boneCache)
 {
 	int				 j, k;
 	mdxmVertex_t* v;
@@ -432,6 +432,24 @@ static void R_TransformEachSurface(const mdxmSurface_t* surface, vec3_t scale, C
 	v = (mdxmVertex_t*)((byte*)surface + surface->ofsVerts);
 	mdxmVertexTexCoord_t* pTexCoords = (mdxmVertexTexCoord_t*)&v[numVerts];
 
+	const mdxmSkinSurf_t* skin = G2_GetSkinSurf(currentModel, surface);
+	if (skin)
+	{
+		const mdxaBone_t* boneList[iMAX_G2_BONEREFS_PER_SURFACE];
+		for (k = 0; k < surface->numBoneReferences; k++)
+		{
+			boneList[k] = &EvalBoneCache(piBoneReferences[k], boneCache);
+		}
+		// positions only, the normals aren't kept, and the texture coords go in after since the skinning writes over them
+		G2_SkinSurface(skin, boneList, TransformedVerts, 5, nullptr, 0, scale);
+		for (j = 0; j < numVerts; j++)
+		{
+			TransformedVerts[j * 5 + 3] = pTexCoords[j].texCoords[0];
+			TransformedVerts[j * 5 + 4] = pTexCoords[j].texCoords[1];
+		}
+		return;
+	}
+
 	// optimisation issue
 	if ((scale[0] != 1.0) || (scale[1] != 1.0) || (scale[2] != 1.0))
 	{
@@ -519,8 +537,253 @@ static void R_TransformEachSurface(const mdxmSurface_t* surface, vec3_t scale, C
 	}
 }
 
+/*
+===============================================================================
+
+TRACE CULLING
+
+A collision check used to skin every surface of the model before looking at the
+ray at all. Each surface of each LOD now keeps, from load, the bind pose box of the
+verts each of its bone references moves. A skinned vert is a blend of its bones'
+transforms of it, so it lies inside the union of those boxes once they are moved by
+their bones, and that union is cheap to work out from the animated bone cache. A
+surface whose union the ray can't reach is never skinned and never traced.
+
+For radius traces the test uses the very slabs G2_RadiusTracePolys rejects polys
+with, so a surface only gets dropped when every poly of it would have been.
+
+===============================================================================
+*/
+
+constexpr float G2_TRACE_CULL_EPSILON = 1.0f;
+
+extern cvar_t* r_Ghoul2TraceCull;
+
+// box the verts each bone reference of each surface of every LOD of a glm that has just been loaded moves
+void G2_BuildSurfBounds(model_t* mod)
+{
+	const mdxmHeader_t* mdxm = mod->mdxm;
+	mdxmSurfBounds_t* bounds = static_cast<mdxmSurfBounds_t*>(R_Hunk_Alloc(sizeof(mdxmSurfBounds_t) * mdxm->numLODs * mdxm->numSurfaces, qtrue));
+
+	const mdxmLOD_t* lod = (mdxmLOD_t*)((byte*)mdxm + mdxm->ofsLODs);
+	for (int l = 0; l < mdxm->numLODs; l++)
+	{
+		const mdxmSurface_t* surf = (mdxmSurface_t*)((byte*)lod + sizeof(mdxmLOD_t) + mdxm->numSurfaces * sizeof(mdxmLODSurfOffset_t));
+		for (int i = 0; i < mdxm->numSurfaces; i++, surf = (mdxmSurface_t*)((byte*)surf + surf->ofsEnd))
+		{
+			mdxmSurfBounds_t& sb = bounds[l * mdxm->numSurfaces + surf->thisSurfaceIndex];
+			if (!surf->numVerts || !surf->numBoneReferences)
+			{
+				continue;
+			}
+
+			sb.bones = static_cast<mdxmBoneBounds_t*>(R_Hunk_Alloc(sizeof(mdxmBoneBounds_t) * surf->numBoneReferences, qfalse));
+			for (int k = 0; k < surf->numBoneReferences; k++)
+			{
+				ClearBounds(sb.bones[k].mins, sb.bones[k].maxs);
+			}
+
+			const mdxmVertex_t* v = (mdxmVertex_t*)((byte*)surf + surf->ofsVerts);
+			for (int j = 0; j < surf->numVerts; j++, v++)
+			{
+				const int iNumWeights = G2_GetVertWeights(v);
+				float fTotalWeight = 0.0f;
+				for (int k = 0; k < iNumWeights; k++)
+				{
+					const int iBoneIndex = G2_GetVertBoneIndex(v, k);
+					assert(iBoneIndex < surf->numBoneReferences);
+					AddPointToBounds(v->vertCoords, sb.bones[iBoneIndex].mins, sb.bones[iBoneIndex].maxs);
+					G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
+				}
+				// the last weight is whatever the others leave of 1, so it goes negative when they add up past it
+				sb.slack = Q_max(sb.slack, fTotalWeight - 1.0f);
+			}
+		}
+		lod = (mdxmLOD_t*)((byte*)lod + lod->ofsEnd);
+	}
+
+	mod->mdxmBounds = bounds;
+}
+
+// the axes G2_RadiusTracePolys measures verts along, s and t across the ray and u along it, each 0..1 inside the trace
+static void G2_RadiusTraceAxes(const vec3_t rayStart, const vec3_t rayEnd, const float radius, vec3_t saxis, vec3_t taxis, vec3_t v3RayDir)
+{
+	vec3_t basis1;
+	vec3_t basis2{};
+
+	basis2[0] = 0.0f;
+	basis2[1] = 0.0f;
+	basis2[2] = 1.0f;
+
+	VectorSubtract(rayEnd, rayStart, v3RayDir);
+
+	CrossProduct(v3RayDir, basis2, basis1);
+
+	if (DotProduct(basis1, basis1) < .1f)
+	{
+		basis2[0] = 0.0f;
+		basis2[1] = 1.0f;
+		basis2[2] = 0.0f;
+		CrossProduct(v3RayDir, basis2, basis1);
+	}
+
+	CrossProduct(v3RayDir, basis1, basis2);
+	// Give me a shot direction not a bunch of zeros :) -Gil
+//	assert(DotProduct(basis1,basis1)>.0001f);
+//	assert(DotProduct(basis2,basis2)>.0001f);
+
+	VectorNormalize(basis1);
+	VectorNormalize(basis2);
+
+	const float c = cos(0.0f);//theta
+	const float s = sin(0.0f);//theta
+
+	VectorScale(basis1, 0.5f * c / radius, taxis);
+	VectorMA(taxis, 0.5f * s / radius, basis2, taxis);
+
+	VectorScale(basis1, -0.5f * s / radius, saxis);
+	VectorMA(saxis, 0.5f * c / radius, basis2, saxis);
+
+	//rayDir/=lengthSquared(raydir);
+	const float f = VectorLengthSquared(v3RayDir);
+	v3RayDir[0] /= f;
+	v3RayDir[1] /= f;
+	v3RayDir[2] /= f;
+}
+
+// the model space ray of the collision check a model is being skinned for
+struct STraceCull
+{
+	vec3_t	rayStart;
+	vec3_t	rayEnd;
+	float	radius;
+	// radius traces only
+	vec3_t	saxis;
+	vec3_t	taxis;
+	vec3_t	rayDir;
+};
+
+// where the surface's bones have moved its verts to, or false if there's nothing to go on
+static bool G2_SkinnedSurfaceBounds(const model_t* currentModel, const mdxmSurface_t* surface, int lod, CBoneCache* boneCache, const vec3_t scale, vec3_t mins, vec3_t maxs)
+{
+	if (!currentModel->mdxmBounds)
+	{
+		return false;
+	}
+	const mdxmSurfBounds_t& sb = currentModel->mdxmBounds[lod * currentModel->mdxm->numSurfaces + surface->thisSurfaceIndex];
+	if (!sb.bones)
+	{
+		return false;
+	}
+
+	const int* piBoneReferences = (int*)((byte*)surface + surface->ofsBoneReferences);
+	ClearBounds(mins, maxs);
+	for (int k = 0; k < surface->numBoneReferences; k++)
+	{
+		const mdxmBoneBounds_t& bb = sb.bones[k];
+		if (bb.mins[0] > bb.maxs[0])
+		{
+			continue;	// moves no verts
+		}
+
+		const mdxaBone_t& bone = EvalBoneCache(piBoneReferences[k], boneCache);
+		vec3_t center, extents;
+		VectorAdd(bb.mins, bb.maxs, center);
+		VectorScale(center, 0.5f, center);
+		VectorSubtract(bb.maxs, center, extents);
+		for (int i = 0; i < 3; i++)
+		{
+			const float c = DotProduct(bone.matrix[i], center) + bone.matrix[i][3];
+			const float e = Q_fabs(bone.matrix[i][0]) * extents[0] + Q_fabs(bone.matrix[i][1]) * extents[1] + Q_fabs(bone.matrix[i][2]) * extents[2];
+			mins[i] = Q_min(mins[i], c - e);
+			maxs[i] = Q_max(maxs[i], c + e);
+		}
+	}
+	if (mins[0] > maxs[0])
+	{
+		return false;
+	}
+
+	const float pad = G2_TRACE_CULL_EPSILON + sb.slack * Distance(mins, maxs);
+	for (int i = 0; i < 3; i++)
+	{
+		const float a = (mins[i] - pad) * scale[i];
+		const float b = (maxs[i] + pad) * scale[i];
+		mins[i] = Q_min(a, b);
+		maxs[i] = Q_max(a, b);
+	}
+	return true;
+}
+
+// the range of DotProduct(p - rayStart, axis) + bias over a box
+static void G2_BoxAxisRange(const vec3_t mins, const vec3_t maxs, const vec3_t rayStart, const vec3_t axis, const float bias, float& lo, float& hi)
+{
+	vec3_t center, extents;
+	VectorAdd(mins, maxs, center);
+	VectorScale(center, 0.5f, center);
+	VectorSubtract(maxs, center, extents);
+	VectorSubtract(center, rayStart, center);
+	const float c = DotProduct(center, axis) + bias;
+	const float e = Q_fabs(axis[0]) * extents[0] + Q_fabs(axis[1]) * extents[1] + Q_fabs(axis[2]) * extents[2];
+	lo = c - e;
+	hi = c + e;
+}
+
+// can the trace hit anything inside this box
+static bool G2_TraceCullBox(const STraceCull& cull, const vec3_t mins, const vec3_t maxs)
+{
+	float lo, hi;
+	if (!(Q_fabs(cull.radius) < 0.1))
+	{
+		// G2_RadiusTracePolys drops a poly when all its verts are outside one of its six slabs
+		G2_BoxAxisRange(mins, maxs, cull.rayStart, cull.saxis, 0.5f, lo, hi);
+		if (hi <= 0.0f || lo >= 1.0f)
+		{
+			return false;
+		}
+		G2_BoxAxisRange(mins, maxs, cull.rayStart, cull.taxis, 0.5f, lo, hi);
+		if (hi <= 0.0f || lo >= 1.0f)
+		{
+			return false;
+		}
+		G2_BoxAxisRange(mins, maxs, cull.rayStart, cull.rayDir, 0.0f, lo, hi);
+		return hi > 0.0f && lo < 1.0f;
+	}
+
+	// segment against box, one slab at a time
+	float enter = 0.0f;
+	float leave = 1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		const float d = cull.rayEnd[i] - cull.rayStart[i];
+		if (Q_fabs(d) < 1e-6f)
+		{
+			if (cull.rayStart[i] < mins[i] || cull.rayStart[i] > maxs[i])
+			{
+				return false;
+			}
+			continue;
+		}
+		float t0 = (mins[i] - cull.rayStart[i]) / d;
+		float t1 = (maxs[i] - cull.rayStart[i]) / d;
+		if (t0 > t1)
+		{
+			const float t = t0;
+			t0 = t1;
+			t1 = t;
+		}
+		enter = Q_max(enter, t0);
+		leave = Q_min(leave, t1);
+		if (enter > leave)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 static void G2_TransformSurfaces(int surfaceNum, surfaceInfo_v& rootSList,
-	CBoneCache* boneCache, const model_t* currentModel, int lod, vec3_t scale, CMiniHeap* G2VertSpace, intptr_t* TransformedVertArray, bool secondTimeAround)
+	CBoneCache* boneCache, const model_t* currentModel, int lod, vec3_t scale, CMiniHeap* G2VertSpace, intptr_t* TransformedVertArray, bool secondTimeAround, const STraceCull* cull)
 {
 	int	i;
 	assert(currentModel);
@@ -543,7 +806,12 @@ static void G2_TransformSurfaces(int surfaceNum, surfaceInfo_v& rootSList,
 	// if this surface is not off, add it to the shader render list
 	if (!offFlags)
 	{
-		R_TransformEachSurface(surface, scale, G2VertSpace, TransformedVertArray, boneCache);
+		// a surface the ray can't reach is left out, G2_TraceSurfaces skips surfaces that weren't transformed
+		vec3_t mins, maxs;
+		if (!cull || !G2_SkinnedSurfaceBounds(currentModel, surface, lod, boneCache, scale, mins, maxs) || G2_TraceCullBox(*cull, mins, maxs))
+		{
+			R_TransformEachSurface(currentModel, surface, scale, G2VertSpace, TransformedVertArray, boneCache);
+		}
 	}
 
 	// if we are turning off all descendants, then stop this recursion now
@@ -555,15 +823,15 @@ static void G2_TransformSurfaces(int surfaceNum, surfaceInfo_v& rootSList,
 	// now recursively call for the children
 	for (i = 0; i < surfInfo->numChildren; i++)
 	{
-		G2_TransformSurfaces(surfInfo->childIndexes[i], rootSList, boneCache, currentModel, lod, scale, G2VertSpace, TransformedVertArray, secondTimeAround);
+		G2_TransformSurfaces(surfInfo->childIndexes[i], rootSList, boneCache, currentModel, lod, scale, G2VertSpace, TransformedVertArray, secondTimeAround, cull);
 	}
 }
 
 // main calling point for the model transform for collision detection. At this point all of the skeleton has been transformed.
 #ifdef _G2_GORE
-void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, bool ApplyGore, SSkinGoreData* gore)
+static void G2_TransformModelLow(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, bool ApplyGore, SSkinGoreData* gore, const STraceCull* traceCull)
 #else
-void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod)
+static void G2_TransformModelLow(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, const STraceCull* traceCull)
 #endif
 {
 	int lod;
@@ -658,7 +926,7 @@ void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale,
 
 		G2_FindOverrideSurface(-1, g.mSlist); //reset the quick surface override lookup;
 		// recursively call the model surface transform
-		G2_TransformSurfaces(g.mSurfaceRoot, g.mSlist, g.mBoneCache, g.currentModel, lod, correctScale, G2VertSpace, g.mTransformedVertsArray, false);
+		G2_TransformSurfaces(g.mSurfaceRoot, g.mSlist, g.mBoneCache, g.currentModel, lod, correctScale, G2VertSpace, g.mTransformedVertsArray, false, traceCull);
 
 #ifdef _G2_GORE
 
@@ -671,6 +939,41 @@ void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale,
 	}
 }
 
+#ifdef _G2_GORE
+void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, bool ApplyGore, SSkinGoreData* gore)
+{
+	G2_TransformModelLow(ghoul2, frameNum, scale, G2VertSpace, useLod, ApplyGore, gore, nullptr);
+}
+#else
+void G2_TransformModel(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod)
+{
+	G2_TransformModelLow(ghoul2, frameNum, scale, G2VertSpace, useLod, nullptr);
+}
+#endif
+
+// the same for a collision check, given its ray in model space, so only the surfaces the ray might hit get transformed
+void G2_TransformModelForTrace(CGhoul2Info_v& ghoul2, const int frameNum, vec3_t scale, CMiniHeap* G2VertSpace, int useLod, const vec3_t rayStart, const vec3_t rayEnd, const float fRadius)
+{
+	STraceCull		cull;
+	const STraceCull* traceCull = nullptr;
+	if (r_Ghoul2TraceCull->integer)
+	{
+		VectorCopy(rayStart, cull.rayStart);
+		VectorCopy(rayEnd, cull.rayEnd);
+		cull.radius = fRadius;
+		if (!(Q_fabs(fRadius) < 0.1))
+		{
+			G2_RadiusTraceAxes(cull.rayStart, cull.rayEnd, fRadius, cull.saxis, cull.taxis, cull.rayDir);
+		}
+		traceCull = &cull;
+	}
+#ifdef _G2_GORE
+	G2_TransformModelLow(ghoul2, frameNum, scale, G2VertSpace, useLod, false, nullptr, traceCull);
+#else
+	G2_TransformModelLow(ghoul2, frameNum, scale, G2VertSpace, useLod, traceCull);
+#endif
+}
+
 // work out how much space a triangle takes
 static float	G2_AreaOfTri(const vec3_t A, const vec3_t B, const vec3_t C)
 {
@@ -1247,55 +1550,16 @@ static bool G2_RadiusTracePolys(
 )
 {
 	int		j;
-	vec3_t basis1;
-	vec3_t basis2{};
 	vec3_t taxis;
 	vec3_t saxis;
-
-	basis2[0] = 0.0f;
-	basis2[1] = 0.0f;
-	basis2[2] = 1.0f;
-
 	vec3_t v3RayDir;
-	VectorSubtract(TS.rayEnd, TS.rayStart, v3RayDir);
-
-	CrossProduct(v3RayDir, basis2, basis1);
-
-	if (DotProduct(basis1, basis1) < .1f)
-	{
-		basis2[0] = 0.0f;
-		basis2[1] = 1.0f;
-		basis2[2] = 0.0f;
-		CrossProduct(v3RayDir, basis2, basis1);
-	}
-
-	CrossProduct(v3RayDir, basis1, basis2);
-	// Give me a shot direction not a bunch of zeros :) -Gil
-//	assert(DotProduct(basis1,basis1)>.0001f);
-//	assert(DotProduct(basis2,basis2)>.0001f);
 
-	VectorNormalize(basis1);
-	VectorNormalize(basis2);
-
-	const float c = cos(0.0f);//theta
-	const float s = sin(0.0f);//theta
-
-	VectorScale(basis1, 0.5f * c / TS.m_fRadius, taxis);
-	VectorMA(taxis, 0.5f * s / TS.m_fRadius, basis2, taxis);
-
-	VectorScale(basis1, -0.5f * s / TS.m_fRadius, saxis);
-	VectorMA(saxis, 0.5f * c / TS.m_fRadius, basis2, saxis);
+	G2_RadiusTraceAxes(TS.rayStart, TS.rayEnd, TS.m_fRadius, saxis, taxis, v3RayDir);
 
 	const float* const verts = (float*)TS.TransformedVertsArray[surface->thisSurfaceIndex];
 	const int numVerts = surface->numVerts;
 
 	int flags = 63;
-	//rayDir/=lengthSquared(raydir);
-	const float f = VectorLengthSquared(v3RayDir);
-	v3RayDir[0] /= f;
-	v3RayDir[1] /= f;
-	v3RayDir[2] /= f;
-
 	for (j = 0; j < numVerts; j++)
 	{
 		const int pos = j * 5;
@@ -1486,8 +1750,8 @@ static void G2_TraceSurfaces(CTraceSurface& TS)
 		offFlags = surfOverride->offFlags;
 	}
 
-	// if this surface is not off, try to hit it
-	if (!offFlags)
+	// if this surface is not off, try to hit it - unless G2_TransformModel found the ray couldn't
+	if (!offFlags && TS.TransformedVertsArray[surface->thisSurfaceIndex])
 	{
 #ifdef _G2_GORE
 		if (TS.collRecMap)
@@ -1894,6 +2158,7 @@ void G2_LoadGhoul2Model(
 	for (decltype(model_count) i = 0; i < model_count; ++i)
 	{
 		ghoul2[i].mSkelFrameNum = 0;
+		G2_InvalidateBoltCache(&ghoul2[i]);
 		ghoul2[i].mModelindex = -1;
 		ghoul2[i].mFileName[0] = 0;
 		ghoul2[i].mValid = false;
@@ -1933,6 +2198,7 @@ void G2_LoadGhoul2Model(
 
 		ghoul2[i].mBlist.resize(
 			bone_count);
+		ghoul2[i].mBoneSlots.clear();
 
 		// now load all the bones
 		for (decltype(bone_count) x = 0; x < bone_count; ++x)
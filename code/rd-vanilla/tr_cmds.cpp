@@ -82,6 +82,12 @@ static void R_PerformanceCounters(void)
 		ri.Printf(PRINT_ALL, "Tex MB %.2f + buffers %.2f MB = Total %.2fMB\n",
 			tex_size, back_buff * 2 + depth_buff + stencil_buff, tex_size + back_buff * 2 + depth_buff + stencil_buff);
 	}
+	else if (r_speeds->integer == 8) {
+		const int bolt_total = tr.pc.c_g2BoltCacheHits + tr.pc.c_g2BoltCacheMisses;
+		ri.Printf(PRINT_ALL, "g2 bolts:%i cached:%i (%.1f%%) rebuilt:%i\n",
+			bolt_total, tr.pc.c_g2BoltCacheHits,
+			bolt_total ? 100.0f * tr.pc.c_g2BoltCacheHits / bolt_total : 0.0f, tr.pc.c_g2BoltCacheMisses);
+	}
 
 	memset(&tr.pc, 0, sizeof tr.pc);
 	memset(&backEnd.pc, 0, sizeof backEnd.pc);
@@ -74,11 +74,18 @@ void G2Time_ReportTimers(void)
 #include <cfloat>
 //rww - RAGDOLL_END
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define G2_SSE2_SKINNING
+#include <emmintrin.h>
+#endif
+
 extern	cvar_t* r_Ghoul2UnSqash;
 extern	cvar_t* r_Ghoul2AnimSmooth;
 extern	cvar_t* r_Ghoul2NoLerp;
 extern	cvar_t* r_Ghoul2NoBlend;
 extern	cvar_t* r_Ghoul2UnSqashAfterSmooth;
+extern	cvar_t* r_Ghoul2BoltCache;
+extern	cvar_t* r_Ghoul2SimdSkin;
 
 bool HackadelicOnClient = false; // means this is a render traversal
 
@@ -227,6 +234,17 @@ public:
 	int				mLastLastTouch;
 	//rww - RAGDOLL_END
 
+	// model space bolt matrices handed out by G2API_GetBoltMatrix, good for one skeleton build
+	struct SBoltCache
+	{
+		int			touch;
+		int			generation;
+		vec3_t		scale;
+		mdxaBone_t	matrix;
+	};
+	std::vector<SBoltCache> mBoltCache;
+	int				mBoltCacheGeneration;
+
 	// for render smoothing
 	bool			mSmoothingActive;
 	bool			mUnsquash;
@@ -236,7 +254,7 @@ public:
 	CBoneCache(const model_t* amod, const mdxaHeader_t* aheader) : frameSize(0),
 		header(aheader),
 		mod(amod), rootBoneList(nullptr), rootMatrix(),
-		incomingTime(0), mCurrentTouchRender(0)
+		incomingTime(0), mCurrentTouchRender(0), mBoltCacheGeneration(0)
 	{
 		assert(amod);
 		assert(aheader);
@@ -1104,7 +1122,7 @@ void G2_TimingModel(boneInfo_t& bone, const int current_time, const int numFrame
 //basically construct a seperate skeleton with full hierarchy to store a matrix
 //off which will give us the desired settling position given the frame in the skeleton
 //that should be used -rww
-int G2_Add_Bone(const model_t* mod, boneInfo_v& blist, const char* boneName);
+int G2_Add_Bone(const CGhoul2Info* ghlInfo, boneInfo_v& blist, const char* boneName);
 int G2_Find_Bone(const CGhoul2Info* ghlInfo, const boneInfo_v& blist, const char* boneName);
 
 void G2_RagGetAnimMatrix(CGhoul2Info& ghoul2, const int bone_num, mdxaBone_t& matrix, const int frame)
@@ -1137,7 +1155,7 @@ void G2_RagGetAnimMatrix(CGhoul2Info& ghoul2, const int bone_num, mdxaBone_t& ma
 #ifdef _RAG_PRINT_TEST
 			Com_Printf("Attempting to add %s\n", skel->name);
 #endif
-			bListIndex = G2_Add_Bone(ghoul2.animModel, ghoul2.mBlist, skel->name);
+			bListIndex = G2_Add_Bone(&ghoul2, ghoul2.mBlist, skel->name);
 		}
 	}
 
@@ -1175,7 +1193,7 @@ void G2_RagGetAnimMatrix(CGhoul2Info& ghoul2, const int bone_num, mdxaBone_t& ma
 			parentBlistIndex = G2_Find_Bone(&ghoul2, ghoul2.mBlist, pskel->name);
 			if (parentBlistIndex == -1)
 			{
-				parentBlistIndex = G2_Add_Bone(ghoul2.animModel, ghoul2.mBlist, pskel->name);
+				parentBlistIndex = G2_Add_Bone(&ghoul2, ghoul2.mBlist, pskel->name);
 			}
 		}
 
@@ -2099,6 +2117,78 @@ void G2_GetBoltMatrixLow(CGhoul2Info& ghoul2, const int boltNum, const vec3_t sc
 	}
 }
 
+// the bolt in model space, scaled and with the rotation normalized, ready to be taken into world space
+static void G2_GetBoltMatrixModel(CGhoul2Info& ghoul2, const int boltNum, const vec3_t scale, mdxaBone_t& retMatrix)
+{
+	G2_GetBoltMatrixLow(ghoul2, boltNum, scale, retMatrix);
+	// scale the bolt position by the scale factor for this model since at this point its still in model space
+	if (scale[0])
+	{
+		retMatrix.matrix[0][3] *= scale[0];
+	}
+	if (scale[1])
+	{
+		retMatrix.matrix[1][3] *= scale[1];
+	}
+	if (scale[2])
+	{
+		retMatrix.matrix[2][3] *= scale[2];
+	}
+	VectorNormalize(reinterpret_cast<float*>(&retMatrix.matrix[0]));
+	VectorNormalize(reinterpret_cast<float*>(&retMatrix.matrix[1]));
+	VectorNormalize(reinterpret_cast<float*>(&retMatrix.matrix[2]));
+}
+
+// Same as G2_GetBoltMatrixModel, but remembers the answer until the skeleton is rebuilt or something
+// about the instance changes. The world transform is applied by the caller, so angles and origin
+// don't have to be part of the key.
+void G2_GetBoltMatrixCached(CGhoul2Info& ghoul2, const int boltNum, const vec3_t scale, mdxaBone_t& retMatrix)
+{
+	CBoneCache* boneCache = ghoul2.mBoneCache;
+	if (!boneCache || !r_Ghoul2BoltCache->integer)
+	{
+		G2_GetBoltMatrixModel(ghoul2, boltNum, scale, retMatrix);
+		return;
+	}
+	assert(boltNum >= 0 && boltNum < static_cast<int>(ghoul2.mBltlist.size()));
+	if (boltNum >= static_cast<int>(boneCache->mBoltCache.size()))
+	{
+		boneCache->mBoltCache.resize(ghoul2.mBltlist.size());
+	}
+	CBoneCache::SBoltCache& entry = boneCache->mBoltCache[boltNum];
+	if (entry.touch == boneCache->mCurrentTouch &&
+		entry.generation == boneCache->mBoltCacheGeneration &&
+		VectorCompare(entry.scale, scale))
+	{
+		tr.pc.c_g2BoltCacheHits++;
+		retMatrix = entry.matrix;
+		return;
+	}
+	tr.pc.c_g2BoltCacheMisses++;
+	G2_GetBoltMatrixModel(ghoul2, boltNum, scale, retMatrix);
+	entry.touch = boneCache->mCurrentTouch;
+	entry.generation = boneCache->mBoltCacheGeneration;
+	VectorCopy(scale, entry.scale);
+	entry.matrix = retMatrix;
+}
+
+// bone controls, surfaces or bolts changed on this instance, forget every cached bolt
+void G2_InvalidateBoltCache(const CGhoul2Info* ghlInfo)
+{
+	if (ghlInfo && ghlInfo->mBoneCache)
+	{
+		ghlInfo->mBoneCache->mBoltCacheGeneration++;
+	}
+}
+
+void G2_InvalidateBoltCache(const CGhoul2Info_v& ghoul2)
+{
+	for (int i = 0; i < ghoul2.size(); i++)
+	{
+		G2_InvalidateBoltCache(&ghoul2[i]);
+	}
+}
+
 void G2API_SetSurfaceOnOffFromSkin(CGhoul2Info* ghlInfo, const qhandle_t render_skin)
 {
 	const skin_t* skin = R_GetSkinByHandle(render_skin);
@@ -2108,6 +2198,7 @@ void G2API_SetSurfaceOnOffFromSkin(CGhoul2Info* ghlInfo, const qhandle_t render_
 	{
 		ghlInfo->mSlist.clear();	//remove any overrides we had before.
 		ghlInfo->mMeshFrameNum = 0;
+		G2_InvalidateBoltCache(ghlInfo);
 		for (int j = 0; j < skin->numSurfaces; j++)
 		{
 			uint32_t flags;
@@ -2664,6 +2755,306 @@ void G2_ConstructGhoulSkeleton(CGhoul2Info_v& ghoul2, const int frameNum, const
 	}
 }
 
+// skin a surface's verts one at a time straight from the mesh file, normals only by the first bone
+static void RB_SkinGhoulSurface(const mdxmSurface_t* surface, CBoneCache* bones, vec4_t* xyz, vec4_t* normal)
+{
+	const int* piBoneReferences = reinterpret_cast<const int*>(reinterpret_cast<const byte*>(surface) + surface->ofsBoneReferences);
+	const mdxmVertex_t* v = reinterpret_cast<const mdxmVertex_t*>(reinterpret_cast<const byte*>(surface) + surface->ofsVerts);
+	const int numVerts = surface->numVerts;
+
+	float fTotalWeight;
+	float fBoneWeight;
+	float t1;
+	float t2;
+	const mdxaBone_t* bone;
+	const mdxaBone_t* bone2;
+	for (int j = 0; j < numVerts; j++, v++)
+	{
+#ifdef JK2_MODE
+		bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
+#else
+		bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
+#endif // JK2_MODE
+		const int iNumWeights = G2_GetVertWeights(v);
+		normal[j][0] = DotProduct(bone->matrix[0], v->normal);
+		normal[j][1] = DotProduct(bone->matrix[1], v->normal);
+		normal[j][2] = DotProduct(bone->matrix[2], v->normal);
+
+		if (iNumWeights == 1)
+		{
+			xyz[j][0] = DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3];
+			xyz[j][1] = DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3];
+			xyz[j][2] = DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3];
+		}
+		else
+		{
+			fBoneWeight = G2_GetVertBoneWeightNotSlow(v, 0);
+			if (iNumWeights == 2)
+			{
+#ifdef JK2_MODE
+				bone2 = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
+#else
+				bone2 = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
+#endif // JK2_MODE
+				/*
+				useless transposition
+				tess.xyz[baseVertex][0] =
+				v[0]*(w*(bone->matrix[0][0]-bone2->matrix[0][0])+bone2->matrix[0][0])+
+				v[1]*(w*(bone->matrix[0][1]-bone2->matrix[0][1])+bone2->matrix[0][1])+
+				v[2]*(w*(bone->matrix[0][2]-bone2->matrix[0][2])+bone2->matrix[0][2])+
+				w*(bone->matrix[0][3]-bone2->matrix[0][3]) + bone2->matrix[0][3];
+				*/
+				t1 = DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3];
+				t2 = DotProduct(bone2->matrix[0], v->vertCoords) + bone2->matrix[0][3];
+				xyz[j][0] = fBoneWeight * (t1 - t2) + t2;
+				t1 = DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3];
+				t2 = DotProduct(bone2->matrix[1], v->vertCoords) + bone2->matrix[1][3];
+				xyz[j][1] = fBoneWeight * (t1 - t2) + t2;
+				t1 = DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3];
+				t2 = DotProduct(bone2->matrix[2], v->vertCoords) + bone2->matrix[2][3];
+				xyz[j][2] = fBoneWeight * (t1 - t2) + t2;
+			}
+			else
+			{
+				xyz[j][0] = fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
+				xyz[j][1] = fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
+				xyz[j][2] = fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
+
+				fTotalWeight = fBoneWeight;
+				int k;
+				for (k = 1; k < iNumWeights - 1; k++)
+				{
+#ifdef JK2_MODE
+					bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
+#else
+					bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
+#endif // JK2_MODE
+
+					fBoneWeight = G2_GetVertBoneWeightNotSlow(v, k);
+					fTotalWeight += fBoneWeight;
+
+					xyz[j][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
+					xyz[j][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
+					xyz[j][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
+				}
+
+#ifdef JK2_MODE
+				bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
+#else
+				bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
+#endif // JK2_MODE
+				fBoneWeight = 1.0f - fTotalWeight;
+
+				xyz[j][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
+				xyz[j][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
+				xyz[j][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
+			}
+		}
+	}
+}
+
+/*
+===============================================================================
+
+SSE2 SKINNING
+
+Every glm surface gets its verts regrouped four to a block as the mesh loads, each
+component of the four verts in one row, with the bone weights already unpacked and
+the bone indexes padded out so all four verts use as many weights as the heaviest.
+Skinning a block then loads the four bone matrices a weight refers to, transposes
+them so each matrix element is a row across the four verts, and sums the weighted
+positions the way the collision loop in G2_misc.cpp does. The scalar renderer loop
+lerps between the two bones of a two weight vert instead, so those verts can come
+out a few float ulps (well under a thousandth of a unit on a player model) from
+what it would give, with everything else matching. The blocks are only read, so the
+same stream serves the renderer and the collision code, and r_ghoul2simdskin 0 goes
+back to the scalar loops.
+
+===============================================================================
+*/
+
+// unpack every surface of every LOD of a glm that has just been loaded
+void G2_BuildSkinSurfs(model_t* mod)
+{
+#ifdef G2_SSE2_SKINNING
+	const mdxmHeader_t* mdxm = mod->mdxm;
+	mdxmSkinSurf_t* skins = static_cast<mdxmSkinSurf_t*>(R_Hunk_Alloc(sizeof(mdxmSkinSurf_t) * mdxm->numLODs * mdxm->numSurfaces, qtrue));
+
+	const mdxmLOD_t* lod = reinterpret_cast<const mdxmLOD_t*>(reinterpret_cast<const byte*>(mdxm) + mdxm->ofsLODs);
+	for (int l = 0; l < mdxm->numLODs; l++)
+	{
+		const mdxmSurface_t* surf = reinterpret_cast<const mdxmSurface_t*>(reinterpret_cast<const byte*>(lod) + sizeof(mdxmLOD_t) + mdxm->numSurfaces * sizeof(mdxmLODSurfOffset_t));
+		for (int i = 0; i < mdxm->numSurfaces; i++, surf = reinterpret_cast<const mdxmSurface_t*>(reinterpret_cast<const byte*>(surf) + surf->ofsEnd))
+		{
+			mdxmSkinSurf_t& skin = skins[l * mdxm->numSurfaces + surf->thisSurfaceIndex];
+			if (!surf->numVerts || surf->numBoneReferences > iMAX_G2_BONEREFS_PER_SURFACE)
+			{
+				continue;
+			}
+
+			skin.numVerts = surf->numVerts;
+			skin.numBlocks = surf->numVerts + 3 >> 2;
+			skin.blocks = static_cast<mdxmSkinBlock_t*>(R_Hunk_Alloc(sizeof(mdxmSkinBlock_t) * skin.numBlocks, qtrue));
+
+			const mdxmVertex_t* verts = reinterpret_cast<const mdxmVertex_t*>(reinterpret_cast<const byte*>(surf) + surf->ofsVerts);
+			for (int j = 0; j < skin.numBlocks * 4; j++)
+			{
+				mdxmSkinBlock_t& block = skin.blocks[j >> 2];
+				const int lane = j & 3;
+				// the lanes past the end of the surface repeat its last vert, and are never stored
+				const mdxmVertex_t* v = &verts[Q_min(j, surf->numVerts - 1)];
+				const int iNumWeights = G2_GetVertWeights(v);
+
+				for (int c = 0; c < 3; c++)
+				{
+					block.xyz[c][lane] = v->vertCoords[c];
+					block.normal[c][lane] = v->normal[c];
+				}
+
+				float fTotalWeight = 0.0f;
+				for (int k = 0; k < iNumWeights; k++)
+				{
+					block.bones[k][lane] = G2_GetVertBoneIndex(v, k);
+					block.weights[k][lane] = G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
+				}
+				for (int k = iNumWeights; k < iMAX_G2_BONEWEIGHTS_PER_VERT; k++)
+				{
+					block.bones[k][lane] = block.bones[0][lane];
+					block.weights[k][lane] = 0.0f;
+				}
+				block.numWeights = Q_max(block.numWeights, iNumWeights);
+			}
+		}
+		lod = reinterpret_cast<const mdxmLOD_t*>(reinterpret_cast<const byte*>(lod) + lod->ofsEnd);
+	}
+
+	mod->mdxmSkin = skins;
+#endif
+}
+
+// the unpacked verts for one surface of a glm, or null to skin it the scalar way
+const mdxmSkinSurf_t* G2_GetSkinSurf(const model_t* mod, const mdxmSurface_t* surface)
+{
+	if (!mod || !mod->mdxmSkin || !r_Ghoul2SimdSkin->integer)
+	{
+		return nullptr;
+	}
+
+	// the surfaces of each LOD follow each other in the file, so the LOD is whichever one the surface is inside of
+	const mdxmHeader_t* mdxm = mod->mdxm;
+	const byte* lodStart = reinterpret_cast<const byte*>(mdxm) + mdxm->ofsLODs;
+	for (int l = 0; l < mdxm->numLODs; l++)
+	{
+		const byte* lodEnd = lodStart + reinterpret_cast<const mdxmLOD_t*>(lodStart)->ofsEnd;
+		if (reinterpret_cast<const byte*>(surface) > lodStart && reinterpret_cast<const byte*>(surface) < lodEnd)
+		{
+			const mdxmSkinSurf_t* skin = &mod->mdxmSkin[l * mdxm->numSurfaces + surface->thisSurfaceIndex];
+			return skin->blocks ? skin : nullptr;
+		}
+		lodStart = lodEnd;
+	}
+	return nullptr;
+}
+
+#ifdef G2_SSE2_SKINNING
+// the bone matrices for one weight of a block, each element spread across the four verts
+static void G2_LoadSkinBones(const mdxaBone_t* const* bones, const byte* boneIndexes, __m128 m[3][4])
+{
+	for (int r = 0; r < 3; r++)
+	{
+		m[r][0] = _mm_loadu_ps(bones[boneIndexes[0]]->matrix[r]);
+		m[r][1] = _mm_loadu_ps(bones[boneIndexes[1]]->matrix[r]);
+		m[r][2] = _mm_loadu_ps(bones[boneIndexes[2]]->matrix[r]);
+		m[r][3] = _mm_loadu_ps(bones[boneIndexes[3]]->matrix[r]);
+		_MM_TRANSPOSE4_PS(m[r][0], m[r][1], m[r][2], m[r][3]);
+	}
+}
+
+// DotProduct(bone->matrix[r], v) + bone->matrix[r][3] for four verts
+static __m128 G2_SkinRow(const __m128 m[4], const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[1], y)), _mm_mul_ps(m[2], z)), m[3]);
+}
+
+// DotProduct(bone->matrix[r], n) for four verts
+static __m128 G2_SkinNormalRow(const __m128 m[4], const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[1], y)), _mm_mul_ps(m[2], z));
+}
+
+// write the first count verts of a block out as xyz triples, whatever follows them in each vert gets clobbered
+static void G2_StoreSkinBlock(float* out, const int stride, const int count, __m128 x, __m128 y, __m128 z)
+{
+	__m128 w = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_storeu_ps(out, x);
+	if (count > 1)
+	{
+		_mm_storeu_ps(out + stride, y);
+	}
+	if (count > 2)
+	{
+		_mm_storeu_ps(out + stride * 2, z);
+	}
+	if (count > 3)
+	{
+		_mm_storeu_ps(out + stride * 3, w);
+	}
+}
+#endif
+
+// Skin a surface four verts at a time. bones are the surface's bone references already evaluated,
+// each output vert is stride floats apart and needs room for four, normal may be null, and scale,
+// if given, scales the positions afterwards.
+void G2_SkinSurface(const mdxmSkinSurf_t* skin, const mdxaBone_t* const* bones, float* xyz, const int xyzStride, float* normal, const int normalStride, const float* scale)
+{
+#ifdef G2_SSE2_SKINNING
+	__m128 m[3][4];
+	for (int b = 0; b < skin->numBlocks; b++)
+	{
+		const mdxmSkinBlock_t& block = skin->blocks[b];
+		const int count = Q_min(4, skin->numVerts - b * 4);
+
+		G2_LoadSkinBones(bones, block.bones[0], m);
+
+		// the normals only follow the first bone, the same as the scalar renderer path
+		if (normal)
+		{
+			const __m128 nx = _mm_loadu_ps(block.normal[0]);
+			const __m128 ny = _mm_loadu_ps(block.normal[1]);
+			const __m128 nz = _mm_loadu_ps(block.normal[2]);
+			G2_StoreSkinBlock(normal + b * 4 * normalStride, normalStride, count,
+				G2_SkinNormalRow(m[0], nx, ny, nz), G2_SkinNormalRow(m[1], nx, ny, nz), G2_SkinNormalRow(m[2], nx, ny, nz));
+		}
+
+		const __m128 x = _mm_loadu_ps(block.xyz[0]);
+		const __m128 y = _mm_loadu_ps(block.xyz[1]);
+		const __m128 z = _mm_loadu_ps(block.xyz[2]);
+		__m128 w = _mm_loadu_ps(block.weights[0]);
+		__m128 px = _mm_mul_ps(w, G2_SkinRow(m[0], x, y, z));
+		__m128 py = _mm_mul_ps(w, G2_SkinRow(m[1], x, y, z));
+		__m128 pz = _mm_mul_ps(w, G2_SkinRow(m[2], x, y, z));
+		for (int k = 1; k < block.numWeights; k++)
+		{
+			G2_LoadSkinBones(bones, block.bones[k], m);
+			w = _mm_loadu_ps(block.weights[k]);
+			px = _mm_add_ps(px, _mm_mul_ps(w, G2_SkinRow(m[0], x, y, z)));
+			py = _mm_add_ps(py, _mm_mul_ps(w, G2_SkinRow(m[1], x, y, z)));
+			pz = _mm_add_ps(pz, _mm_mul_ps(w, G2_SkinRow(m[2], x, y, z)));
+		}
+		if (scale)
+		{
+			px = _mm_mul_ps(px, _mm_set1_ps(scale[0]));
+			py = _mm_mul_ps(py, _mm_set1_ps(scale[1]));
+			pz = _mm_mul_ps(pz, _mm_set1_ps(scale[2]));
+		}
+		G2_StoreSkinBlock(xyz + b * 4 * xyzStride, xyzStride, count, px, py, pz);
+	}
+#else
+	assert(0); // G2_BuildSkinSurfs never made any blocks
+#endif
+}
+
 /*
 ==============
 RB_SurfaceGhoul
@@ -2675,7 +3066,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 	G2PerformanceTimer_RB_SurfaceGhoul.Start();
 #endif
 
-	int				j, k;
+	int				j;
 	int				baseIndex, baseVertex;
 	int				numVerts;
 	mdxmVertex_t* v;
@@ -2837,146 +3228,30 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 	v = reinterpret_cast<mdxmVertex_t*>(reinterpret_cast<byte*>(surface) + surface->ofsVerts);
 	pTexCoords = reinterpret_cast<mdxmVertexTexCoord_t*>(&v[numVerts]);
 
-	//	if (r_ghoul2fastnormals&&r_ghoul2fastnormals->integer==0)
-#if 0
-	if (0)
+	const mdxmSkinSurf_t* skin = G2_GetSkinSurf(bones->mod, surface);
+	if (skin)
 	{
-		for (j = 0; j < numVerts; j++, baseVertex++, v++)
+		const mdxaBone_t* boneList[iMAX_G2_BONEREFS_PER_SURFACE];
+		for (j = 0; j < surface->numBoneReferences; j++)
 		{
-			const int iNumWeights = G2_GetVertWeights(v);
-
-			float fTotalWeight = 0.0f;
-
-			k = 0;
-			int		iBoneIndex = G2_GetVertBoneIndex(v, k);
-			float	fBoneWeight = G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
-			const mdxaBone_t* bone = &bones->EvalRender(piBoneReferences[iBoneIndex]);
-
-			tess.xyz[baseVertex][0] = fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
-			tess.xyz[baseVertex][1] = fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
-			tess.xyz[baseVertex][2] = fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
-
-			tess.normal[baseVertex][0] = fBoneWeight * DotProduct(bone->matrix[0], v->normal);
-			tess.normal[baseVertex][1] = fBoneWeight * DotProduct(bone->matrix[1], v->normal);
-			tess.normal[baseVertex][2] = fBoneWeight * DotProduct(bone->matrix[2], v->normal);
-
-			for (k++; k < iNumWeights; k++)
-			{
-				iBoneIndex = G2_GetVertBoneIndex(v, k);
-				fBoneWeight = G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
-
-				bone = &bones->EvalRender(piBoneReferences[iBoneIndex]);
-
-				tess.xyz[baseVertex][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
-				tess.xyz[baseVertex][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
-				tess.xyz[baseVertex][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
-
-				tess.normal[baseVertex][0] += fBoneWeight * DotProduct(bone->matrix[0], v->normal);
-				tess.normal[baseVertex][1] += fBoneWeight * DotProduct(bone->matrix[1], v->normal);
-				tess.normal[baseVertex][2] += fBoneWeight * DotProduct(bone->matrix[2], v->normal);
-			}
-
-			tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
-			tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
+#ifdef JK2_MODE
+			boneList[j] = &bones->Eval(piBoneReferences[j]);
+#else
+			boneList[j] = &bones->EvalRender(piBoneReferences[j]);
+#endif // JK2_MODE
 		}
+		G2_SkinSurface(skin, boneList, tess.xyz[baseVertex], 4, tess.normal[baseVertex], 4, nullptr);
 	}
 	else
 	{
-#endif
-		float fTotalWeight;
-		float fBoneWeight;
-		float t1;
-		float t2;
-		const mdxaBone_t* bone;
-		const mdxaBone_t* bone2;
-		for (j = 0; j < numVerts; j++, baseVertex++, v++)
-		{
-#ifdef JK2_MODE
-			bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
-#else
-			bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
-#endif // JK2_MODE
-			int iNumWeights = G2_GetVertWeights(v);
-			tess.normal[baseVertex][0] = DotProduct(bone->matrix[0], v->normal);
-			tess.normal[baseVertex][1] = DotProduct(bone->matrix[1], v->normal);
-			tess.normal[baseVertex][2] = DotProduct(bone->matrix[2], v->normal);
-
-			if (iNumWeights == 1)
-			{
-				tess.xyz[baseVertex][0] = DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3];
-				tess.xyz[baseVertex][1] = DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3];
-				tess.xyz[baseVertex][2] = DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3];
-			}
-			else
-			{
-				fBoneWeight = G2_GetVertBoneWeightNotSlow(v, 0);
-				if (iNumWeights == 2)
-				{
-#ifdef JK2_MODE
-					bone2 = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
-#else
-					bone2 = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
-#endif // JK2_MODE
-					/*
-					useless transposition
-					tess.xyz[baseVertex][0] =
-					v[0]*(w*(bone->matrix[0][0]-bone2->matrix[0][0])+bone2->matrix[0][0])+
-					v[1]*(w*(bone->matrix[0][1]-bone2->matrix[0][1])+bone2->matrix[0][1])+
-					v[2]*(w*(bone->matrix[0][2]-bone2->matrix[0][2])+bone2->matrix[0][2])+
-					w*(bone->matrix[0][3]-bone2->matrix[0][3]) + bone2->matrix[0][3];
-					*/
-					t1 = DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3];
-					t2 = DotProduct(bone2->matrix[0], v->vertCoords) + bone2->matrix[0][3];
-					tess.xyz[baseVertex][0] = fBoneWeight * (t1 - t2) + t2;
-					t1 = DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3];
-					t2 = DotProduct(bone2->matrix[1], v->vertCoords) + bone2->matrix[1][3];
-					tess.xyz[baseVertex][1] = fBoneWeight * (t1 - t2) + t2;
-					t1 = DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3];
-					t2 = DotProduct(bone2->matrix[2], v->vertCoords) + bone2->matrix[2][3];
-					tess.xyz[baseVertex][2] = fBoneWeight * (t1 - t2) + t2;
-				}
-				else
-				{
-					tess.xyz[baseVertex][0] = fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
-					tess.xyz[baseVertex][1] = fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
-					tess.xyz[baseVertex][2] = fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
-
-					fTotalWeight = fBoneWeight;
-					for (k = 1; k < iNumWeights - 1; k++)
-					{
-#ifdef JK2_MODE
-						bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#else
-						bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#endif // JK2_MODE
-
-						fBoneWeight = G2_GetVertBoneWeightNotSlow(v, k);
-						fTotalWeight += fBoneWeight;
-
-						tess.xyz[baseVertex][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
-						tess.xyz[baseVertex][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
-						tess.xyz[baseVertex][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
-					}
-
-#ifdef JK2_MODE
-					bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#else
-					bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#endif // JK2_MODE
-					fBoneWeight = 1.0f - fTotalWeight;
-
-					tess.xyz[baseVertex][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
-					tess.xyz[baseVertex][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
-					tess.xyz[baseVertex][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
-				}
-			}
+		RB_SkinGhoulSurface(surface, bones, &tess.xyz[baseVertex], &tess.normal[baseVertex]);
+	}
 
-			tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
-			tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
-		}
-#if 0
+	for (j = 0; j < numVerts; j++, baseVertex++)
+	{
+		tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
+		tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
 	}
-#endif
 
 #ifdef _G2_GORE
 	while (surf->goreChain)
@@ -3526,6 +3801,8 @@ qboolean R_LoadMDXM(model_t* mod, void* buffer, const char* mod_name, qboolean&
 
 	if (bAlreadyFound)
 	{
+		G2_BuildSkinSurfs(mod);
+		G2_BuildSurfBounds(mod);
 		return qtrue;	// All done. Stop, go no further, do not LittleLong(), do not pass Go...
 	}
 
@@ -3695,6 +3972,8 @@ qboolean R_LoadMDXM(model_t* mod, void* buffer, const char* mod_name, qboolean&
 		lod = reinterpret_cast<mdxmLOD_t*>(reinterpret_cast<byte*>(lod) + lod->ofsEnd);
 	}
 
+	G2_BuildSkinSurfs(mod);
+	G2_BuildSurfBounds(mod);
 	return qtrue;
 }
 
@@ -3775,6 +4054,7 @@ qboolean R_LoadMDXA(model_t* mod, void* buffer, const char* mod_name, qboolean&
 
 	if (bAlreadyFound)
 	{
+		G2_Build_Bone_Name_Hash(mod);
 		return qtrue;	// All done, stop here, do not LittleLong() etc. Do not pass go...
 	}
 
@@ -3830,5 +4110,6 @@ qboolean R_LoadMDXA(model_t* mod, void* buffer, const char* mod_name, qboolean&
 			LS(pwIn[k]);
 	}
 #endif
+	G2_Build_Bone_Name_Hash(mod);
 	return qtrue;
 }
\ No newline at end of file
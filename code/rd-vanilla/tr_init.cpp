@@ -159,6 +159,10 @@ cvar_t* r_Ghoul2TimeBase = nullptr;
 cvar_t* r_Ghoul2NoLerp;
 cvar_t* r_Ghoul2NoBlend;
 cvar_t* r_Ghoul2BlendMultiplier = nullptr;
+cvar_t* r_Ghoul2BoneHash;
+cvar_t* r_Ghoul2BoltCache;
+cvar_t* r_Ghoul2SimdSkin;
+cvar_t* r_Ghoul2TraceCull;
 cvar_t* r_Ghoul2UnSqashAfterSmooth;
 
 cvar_t* broadsword;
@@ -1673,6 +1677,10 @@ void R_Register()
 	r_Ghoul2NoLerp = ri.Cvar_Get("r_ghoul2nolerp", "0", 0);
 	r_Ghoul2NoBlend = ri.Cvar_Get("r_ghoul2noblend", "0", 0);
 	r_Ghoul2BlendMultiplier = ri.Cvar_Get("r_ghoul2blendmultiplier", "1", 0);
+	r_Ghoul2BoneHash = ri.Cvar_Get("r_ghoul2bonehash", "1", 0);
+	r_Ghoul2BoltCache = ri.Cvar_Get("r_ghoul2boltcache", "1", 0);
+	r_Ghoul2SimdSkin = ri.Cvar_Get("r_ghoul2simdskin", "1", 0);
+	r_Ghoul2TraceCull = ri.Cvar_Get("r_ghoul2tracecull", "1", 0);
 	r_Ghoul2UnSqashAfterSmooth = ri.Cvar_Get("r_ghoul2unsquashaftersmooth", "1", 0);
 
 	broadsword = ri.Cvar_Get("broadsword", "1", 0);
@@ -783,6 +783,46 @@ using modtype_t = enum {
 	*/
 };
 
+// a gla's bone names, hashed case-insensitively to skeleton indexes when it loads so
+// ghoul2's by-name bone calls don't have to stricmp their way down the skeleton
+using mdxaBoneHash_t = struct
+{
+	int mask; // table size - 1
+	short bones[1]; // variable sized, linear probed, -1 if empty
+};
+
+// a glm surface's verts regrouped four at a time, one component per row, built when the mesh
+// loads so ghoul2 skinning can transform four verts per pass with SSE2
+using mdxmSkinBlock_t = struct
+{
+	float	xyz[3][4];
+	float	normal[3][4];
+	float	weights[iMAX_G2_BONEWEIGHTS_PER_VERT][4];	// the last weight of each vert is already 1 - the others
+	byte	bones[iMAX_G2_BONEWEIGHTS_PER_VERT][4];		// indexes into the surface's bone references
+	int		numWeights;									// most weights any of the four verts has
+};
+
+using mdxmSkinSurf_t = struct
+{
+	int					numVerts;
+	int					numBlocks;
+	mdxmSkinBlock_t* blocks;	// null if the surface can't be skinned this way
+};
+
+// bind pose bounds of the verts each bone of a glm surface moves, so a ghoul2 trace can cull the
+// surface against the posed skeleton before skinning any of it
+using mdxmBoneBounds_t = struct
+{
+	vec3_t	mins;
+	vec3_t	maxs;
+};
+
+using mdxmSurfBounds_t = struct
+{
+	mdxmBoneBounds_t* bones;	// one per bone reference, null if the surface has no verts
+	float	slack;				// how far outside the boxes a negative last weight can push a vert, as a fraction of their size
+};
+
 using model_t = struct model_s {
 	char		name[MAX_QPATH];
 	modtype_t	type;
@@ -796,6 +836,9 @@ using model_t = struct model_s {
 	*/
 	mdxmHeader_t* mdxm;				// only if type == MOD_GL2M which is a GHOUL II Mesh file NOT a GHOUL II animation file
 	mdxaHeader_t* mdxa;				// only if type == MOD_GL2A which is a GHOUL II Animation file
+	mdxaBoneHash_t* mdxaBoneHash;	// only if type == MOD_GL2A
+	mdxmSkinSurf_t* mdxmSkin;		// only if type == MOD_GL2M, [lod * numSurfaces + surface]
+	mdxmSurfBounds_t* mdxmBounds;	// only if type == MOD_GL2M, [lod * numSurfaces + surface]
 	/*
 	Ghoul2 Insert End
 	*/
@@ -814,6 +857,11 @@ void		R_ModelBounds(qhandle_t handle, vec3_t mins, vec3_t maxs);
 
 void		R_Modellist_f();
 
+void G2_BuildSkinSurfs(model_t* mod);
+const mdxmSkinSurf_t* G2_GetSkinSurf(const model_t* mod, const mdxmSurface_t* surface);
+void G2_SkinSurface(const mdxmSkinSurf_t* skin, const mdxaBone_t* const* bones, float* xyz, int xyzStride, float* normal, int normalStride, const float* scale);
+void G2_BuildSurfBounds(model_t* mod);
+
 //====================================================
 constexpr auto MAX_DRAWIMAGES = 4096;
 constexpr auto MAX_LIGHTMAPS = 512;
@@ -869,6 +917,8 @@ using frontEndCounters_t = struct {
 	int		c_leafs;
 	int		c_dlightSurfaces;
 	int		c_dlightSurfacesCulled;
+
+	int		c_g2BoltCacheHits, c_g2BoltCacheMisses;	// G2API_GetBoltMatrix, game side included
 };
 
 #define	FOG_TABLE_SIZE		256
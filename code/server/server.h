@@ -41,15 +41,32 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 constexpr auto MAX_ENT_CLUSTERS = 16;
 
+using svTraceCacheState_t = struct
+{
+	int contents; // the contents a cached trace could hit, 0 if none or not linked
+	vec3_t absmin, absmax;
+	vec3_t angles;
+};
+
+using svPvsByte_t = struct
+{
+	int offset; // into a PVS row
+	byte bits; // the entity's clusters in that byte
+};
+
 using svEntity_t = struct svEntity_s
 {
 	struct worldSector_s* worldSector;
 	svEntity_s* nextEntityInWorldSector;
+	int worldTreeNode; // leaf in the aabb tree when sv_worldIndex is 1, 0 = not in it
+	svTraceCacheState_t traceCacheState; // as the trace cache last saw it linked
 
 	entityState_t baseline; // for delta compression of initial sighting
 	int numClusters; // if -1, use headnode instead
 	int clusternums[MAX_ENT_CLUSTERS];
 	int lastCluster; // if all the clusters don't fit in clusternums
+	int numPvsBytes;
+	svPvsByte_t pvsBytes[MAX_ENT_CLUSTERS]; // clusternums, grouped by byte
 	int areanum, areanum2;
 	int snapshotCounter; // used to prevent double adding from portal views
 };
@@ -180,6 +197,8 @@ extern cvar_t* sv_mapChecksum;
 extern cvar_t* sv_serverid;
 extern cvar_t* sv_testsave;
 extern cvar_t* sv_compress_saved_games;
+extern cvar_t* sv_worldIndex;
+extern cvar_t* sv_traceCache;
 
 //===========================================================
 
@@ -266,6 +285,9 @@ int SV_AreaEntities(const vec3_t mins, const vec3_t maxs, gentity_t** elist, int
 // returns the number of pointers filled in
 // The world entity is never returned in this list.
 
+int SV_PointLeafnum(const vec3_t p);
+// CM_PointLeafnum, through a memo of recent points
+
 int SV_PointContents(const vec3_t p, int passEntityNum);
 // returns the CONTENTS_* value from the world and all entities at the given point.
 
@@ -277,6 +299,14 @@ void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec
 /*
 Ghoul2 Insert End
 */
+void SV_TraceBatch(trace_t* results, const traceRequest_t* requests, int numRequests);
+// SV_Trace for each request, sharing the work between them where it can
+
+void SV_TraceCacheEntityChanged(const gentity_t* g_ent);
+// drops the cached traces near an entity whose contents change without a relink
+void SV_TraceCacheCheckContents();
+// the same for every entity whose contents differ from when it was linked
+extern int sv_traceCacheHits, sv_traceCacheMisses;
 // mins and maxs are relative
 
 // if the entire move stays in a solid volume, trace.allsolid will be set,
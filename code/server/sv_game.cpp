@@ -197,6 +197,8 @@ void SV_SetBrushModel(gentity_t* ent, const char* name)
 	{
 		Com_Error(ERR_DROP, "SV_SetBrushModel: %s isn't a brush model (ent %d)", name, ent->s.number);
 	}
+
+	SV_TraceCacheEntityChanged(ent); // new contents, and a wall turned back on isn't relinked
 }
 
 const char* SV_SetActiveSubBSP(const int index)
@@ -228,12 +230,12 @@ qboolean SV_inPVS(const vec3_t p1, const vec3_t p2)
 	{
 		start = Sys_Milliseconds();
 	}
-	int leafnum = CM_PointLeafnum(p1);
+	int leafnum = SV_PointLeafnum(p1);
 	int cluster = CM_LeafCluster(leafnum);
 	const int area1 = CM_LeafArea(leafnum);
 	const byte* mask = CM_ClusterPVS(cluster);
 
-	leafnum = CM_PointLeafnum(p2);
+	leafnum = SV_PointLeafnum(p2);
 	cluster = CM_LeafCluster(leafnum);
 	const int area2 = CM_LeafArea(leafnum);
 	if (mask && !(mask[cluster >> 3] & 1 << (cluster & 7)))
@@ -274,11 +276,11 @@ qboolean SV_inPVSIgnorePortals(const vec3_t p1, const vec3_t p2)
 		start = Sys_Milliseconds();
 	}
 
-	int leafnum = CM_PointLeafnum(p1);
+	int leafnum = SV_PointLeafnum(p1);
 	int cluster = CM_LeafCluster(leafnum);
 	const byte* mask = CM_ClusterPVS(cluster);
 
-	leafnum = CM_PointLeafnum(p2);
+	leafnum = SV_PointLeafnum(p2);
 	cluster = CM_LeafCluster(leafnum);
 
 	if (mask && !(mask[cluster >> 3] & 1 << (cluster & 7)))
@@ -304,6 +306,9 @@ SV_AdjustAreaPortalState
 */
 void SV_AdjustAreaPortalState(gentity_t* ent, const qboolean open)
 {
+	// the callers are walls and doors switching their contents on or off in place
+	SV_TraceCacheEntityChanged(ent);
+
 #ifndef JK2_MODE
 	if (!(ent->contents & CONTENTS_OPAQUE))
 	{
@@ -926,6 +931,7 @@ import.unlinkentity = SV_UnlinkEntity;
 import.EntitiesInBox = SV_AreaEntities;
 import.EntityContact = SV_EntityContact;
 import.trace = SV_Trace;
+import.traceBatch = SV_TraceBatch;
 import.pointcontents = SV_PointContents;
 import.totalMapContents = CM_TotalMapContents;
 import.SetBrushModel = SV_SetBrushModel;
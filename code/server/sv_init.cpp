@@ -207,6 +207,9 @@ void SV_SpawnServer(const char* server, const ForceReload_e e_force_reload, cons
 	int i;
 	int checksum;
 
+	// get the background reads of last time's files going before anything else
+	FS_LevelLoadBegin(server);
+
 	re.RegisterMedia_LevelLoadBegin(server, e_force_reload, b_allow_screen_dissolve);
 
 	Cvar_SetValue("cl_paused", 0);
@@ -417,6 +420,8 @@ void SV_Init()
 	sv_mapChecksum = Cvar_Get("sv_mapChecksum", "", CVAR_ROM);
 	sv_testsave = Cvar_Get("sv_testsave", "0", 0);
 	sv_compress_saved_games = Cvar_Get("sv_compress_saved_games", "1", 0);
+	sv_worldIndex = Cvar_Get("sv_worldIndex", "0", CVAR_ARCHIVE_ND);
+	sv_traceCache = Cvar_Get("sv_traceCache", "1", CVAR_ARCHIVE_ND);
 
 	// Only allocated once, no point in moving it around and fragmenting
 	// create a heap for Ghoul2 to use for game side model vertex transforms used in collision detection
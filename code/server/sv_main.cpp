@@ -50,6 +50,8 @@ cvar_t* sv_mapChecksum;
 cvar_t* sv_serverid;
 cvar_t* sv_testsave; // Run the savegame enumeration every game frame
 cvar_t* sv_compress_saved_games; // compress the saved games on the way out (only affect saver, loader can read both)
+cvar_t* sv_worldIndex; // 0 = sector tree, 1 = aabb tree, for entity linking and area queries (takes effect on map load)
+cvar_t* sv_traceCache; // remember the results of traces that only static geometry can stop
 
 /*
 =============================================================================
@@ -547,6 +549,7 @@ void SV_Frame(int msec, const float fraction_msec)
 		sv.timeResidual -= frame_msec;
 		sv.time += frame_msec;
 		re.G2API_SetTime(sv.time, G2T_SV_TIME);
+		SV_TraceCacheCheckContents();
 
 		try
 		{// let everything in the world think and move
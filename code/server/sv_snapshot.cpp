@@ -393,7 +393,7 @@ static void SV_AddEntitiesVisibleFromPoint(vec3_t origin, clientSnapshot_t* fram
 		return;
 	}
 
-	leafnum = CM_PointLeafnum(origin);
+	leafnum = SV_PointLeafnum(origin);
 	clientarea = CM_LeafArea(leafnum);
 	clientcluster = CM_LeafCluster(leafnum);
 
@@ -502,12 +502,10 @@ static void SV_AddEntitiesVisibleFromPoint(vec3_t origin, clientSnapshot_t* fram
 		{
 			continue;
 		}
-		l = 0;
 
-		for (i = 0; i < svEnt->numClusters; i++)
+		for (i = 0; i < svEnt->numPvsBytes; i++)
 		{
-			l = svEnt->clusternums[i];
-			if (bitvector[l >> 3] & (1 << (l & 7)))
+			if (bitvector[svEnt->pvsBytes[i].offset] & svEnt->pvsBytes[i].bits)
 			{
 				break;
 			}
@@ -515,10 +513,11 @@ static void SV_AddEntitiesVisibleFromPoint(vec3_t origin, clientSnapshot_t* fram
 
 		// if we haven't found it to be visible,
 		// check overflow clusters that coudln't be stored
-		if (i == svEnt->numClusters)
+		if (i == svEnt->numPvsBytes)
 		{
 			if (svEnt->lastCluster)
 			{
+				l = svEnt->clusternums[svEnt->numClusters - 1];
 				for (; l <= svEnt->lastCluster; l++)
 				{
 					if (bitvector[l >> 3] & (1 << (l & 7)))
@@ -43,6 +43,8 @@ Ghoul2 Insert Start
 #ifdef _DEBUG
 #include <float.h>
 #endif //_DEBUG
+
+#include <vector>
 /*
 Ghoul2 Insert End
 */
@@ -114,35 +116,682 @@ worldSector_t* SV_CreateworldSector(const int depth, vec3_t mins, vec3_t maxs)
 	worldSector_t* anode = &sv_worldSectors[sv_numworldSectors];
 	sv_numworldSectors++;
 
-	if (depth == AREA_DEPTH)
-	{
-		anode->axis = -1;
-		anode->children[0] = anode->children[1] = nullptr;
-		return anode;
-	}
+	if (depth == AREA_DEPTH)
+	{
+		anode->axis = -1;
+		anode->children[0] = anode->children[1] = nullptr;
+		return anode;
+	}
+
+	VectorSubtract(maxs, mins, size);
+	if (size[0] > size[1])
+	{
+		anode->axis = 0;
+	}
+	else
+	{
+		anode->axis = 1;
+	}
+
+	anode->dist = 0.5 * (maxs[anode->axis] + mins[anode->axis]);
+	VectorCopy(mins, mins1);
+	VectorCopy(mins, mins2);
+	VectorCopy(maxs, maxs1);
+	VectorCopy(maxs, maxs2);
+
+	maxs1[anode->axis] = mins2[anode->axis] = anode->dist;
+
+	anode->children[0] = SV_CreateworldSector(depth + 1, mins2, maxs2);
+	anode->children[1] = SV_CreateworldSector(depth + 1, mins1, maxs1);
+
+	return anode;
+}
+
+/*
+===============================================================================
+
+AABB TREE
+
+The alternative to the sector tree, for sv_worldIndex 1. A dynamic bounding volume
+hierarchy, kept balanced with tree rotations as entities come and go. Every entity
+is a leaf, so big ones don't pile up near the root the way they do on the sector
+tree's splits, however open the map. Leaf boxes are fattened by WORLD_TREE_MARGIN
+so an entity that only moves a little doesn't touch the tree at all.
+
+===============================================================================
+*/
+
+constexpr float WORLD_TREE_MARGIN = 16.0f;
+constexpr int WORLD_TREE_STACK = 256;
+
+using worldTreeNode_t = struct worldTreeNode_s
+{
+	vec3_t mins, maxs; // fattened, for leaves
+	int parent; // next free node, for free nodes
+	int children[2]; // 0 for leaves
+	int height; // 0 for leaves, -1 for free nodes
+	int owner; // entity number, for leaves
+};
+
+// node 0 is never handed out, so 0 means "none" everywhere (and a zeroed svEntity_t isn't in the tree)
+using worldTree_t = struct
+{
+	std::vector<worldTreeNode_t> nodes;
+	int root;
+	int freeList;
+	int numLeafs;
+};
+
+static worldTree_t sv_worldTree;
+static qboolean sv_worldTreeActive; // sv_worldIndex as of the last SV_ClearWorld
+
+static bool SV_BoxesDisjoint(const float* mins1, const float* maxs1, const float* mins2, const float* maxs2)
+{
+	return mins1[0] > maxs2[0] || mins1[1] > maxs2[1] || mins1[2] > maxs2[2]
+		|| maxs1[0] < mins2[0] || maxs1[1] < mins2[1] || maxs1[2] < mins2[2];
+}
+
+// half the surface area, which is what the insertion heuristic compares
+static float SV_WorldTreeBoxCost(const vec3_t mins, const vec3_t maxs)
+{
+	const float dx = maxs[0] - mins[0];
+	const float dy = maxs[1] - mins[1];
+	const float dz = maxs[2] - mins[2];
+	return dx * dy + dy * dz + dz * dx;
+}
+
+static float SV_WorldTreeUnionCost(const worldTreeNode_t& a, const worldTreeNode_t& b)
+{
+	vec3_t mins, maxs;
+	for (int i = 0; i < 3; i++)
+	{
+		mins[i] = Q_min(a.mins[i], b.mins[i]);
+		maxs[i] = Q_max(a.maxs[i], b.maxs[i]);
+	}
+	return SV_WorldTreeBoxCost(mins, maxs);
+}
+
+static void SV_WorldTreeClear(worldTree_t& tree)
+{
+	tree.nodes.clear();
+	tree.nodes.emplace_back();
+	tree.nodes[0].height = -1;
+	tree.root = 0;
+	tree.freeList = 0;
+	tree.numLeafs = 0;
+}
+
+static int SV_WorldTreeAllocNode(worldTree_t& tree)
+{
+	int i;
+	if (tree.freeList)
+	{
+		i = tree.freeList;
+		tree.freeList = tree.nodes[i].parent;
+	}
+	else
+	{
+		i = static_cast<int>(tree.nodes.size());
+		tree.nodes.emplace_back();
+	}
+
+	worldTreeNode_t& node = tree.nodes[i];
+	node.parent = 0;
+	node.children[0] = node.children[1] = 0;
+	node.height = 0;
+	node.owner = -1;
+	return i;
+}
+
+static void SV_WorldTreeFreeNode(worldTree_t& tree, const int i)
+{
+	tree.nodes[i].height = -1;
+	tree.nodes[i].parent = tree.freeList;
+	tree.freeList = i;
+}
+
+// recomputes an interior node's box and height from its children
+static void SV_WorldTreeRefit(worldTree_t& tree, const int i)
+{
+	worldTreeNode_t& node = tree.nodes[i];
+	const worldTreeNode_t& child0 = tree.nodes[node.children[0]];
+	const worldTreeNode_t& child1 = tree.nodes[node.children[1]];
+
+	for (int j = 0; j < 3; j++)
+	{
+		node.mins[j] = Q_min(child0.mins[j], child1.mins[j]);
+		node.maxs[j] = Q_max(child0.maxs[j], child1.maxs[j]);
+	}
+	node.height = 1 + Q_max(child0.height, child1.height);
+}
+
+static void SV_WorldTreeReplaceChild(worldTree_t& tree, const int parent, const int oldChild, const int newChild)
+{
+	if (!parent)
+	{
+		tree.root = newChild;
+	}
+	else if (tree.nodes[parent].children[0] == oldChild)
+	{
+		tree.nodes[parent].children[0] = newChild;
+	}
+	else
+	{
+		tree.nodes[parent].children[1] = newChild;
+	}
+}
+
+/*
+===============
+SV_WorldTreeBalance
+
+If one side of node a is more than one level taller than the other, rotates that
+side's root up into a's place. Returns whichever node is now where a was.
+===============
+*/
+static int SV_WorldTreeBalance(worldTree_t& tree, const int a)
+{
+	if (tree.nodes[a].height < 2)
+	{
+		return a;
+	}
+
+	const int b = tree.nodes[a].children[0];
+	const int c = tree.nodes[a].children[1];
+	const int balance = tree.nodes[c].height - tree.nodes[b].height;
+
+	if (balance < -1 || balance > 1)
+	{
+		// up = the taller child, which takes a's place; a keeps the shorter one,
+		//	plus the shorter of up's children, and up keeps the taller of them
+		const int upSide = balance > 1 ? 1 : 0;
+		const int up = upSide ? c : b;
+		const int up0 = tree.nodes[up].children[0];
+		const int up1 = tree.nodes[up].children[1];
+		const int taller = tree.nodes[up0].height > tree.nodes[up1].height ? up0 : up1;
+		const int shorter = taller == up0 ? up1 : up0;
+
+		tree.nodes[up].children[0] = a;
+		tree.nodes[up].parent = tree.nodes[a].parent;
+		tree.nodes[a].parent = up;
+		SV_WorldTreeReplaceChild(tree, tree.nodes[up].parent, a, up);
+
+		tree.nodes[up].children[1] = taller;
+		tree.nodes[a].children[upSide] = shorter;
+		tree.nodes[shorter].parent = a;
+
+		SV_WorldTreeRefit(tree, a);
+		SV_WorldTreeRefit(tree, up);
+		return up;
+	}
+
+	return a;
+}
+
+// refits and rebalances from node i up to the root
+static void SV_WorldTreeFixUpwards(worldTree_t& tree, int i)
+{
+	while (i)
+	{
+		i = SV_WorldTreeBalance(tree, i);
+		SV_WorldTreeRefit(tree, i);
+		i = tree.nodes[i].parent;
+	}
+}
+
+static void SV_WorldTreeInsertLeaf(worldTree_t& tree, const int leaf)
+{
+	tree.numLeafs++;
+
+	if (!tree.root)
+	{
+		tree.root = leaf;
+		tree.nodes[leaf].parent = 0;
+		return;
+	}
+
+	// walk down to the cheapest sibling, by surface area
+	int i = tree.root;
+	while (tree.nodes[i].height > 0)
+	{
+		const worldTreeNode_t& node = tree.nodes[i];
+		const worldTreeNode_t& leafNode = tree.nodes[leaf];
+
+		const float combined = SV_WorldTreeUnionCost(node, leafNode);
+		const float cost = 2.0f * combined; // cost of a new parent for this node and the leaf
+		const float inheritance = 2.0f * (combined - SV_WorldTreeBoxCost(node.mins, node.maxs)); // cost of growing this node
+
+		float childCost[2];
+		for (int j = 0; j < 2; j++)
+		{
+			const worldTreeNode_t& child = tree.nodes[node.children[j]];
+			childCost[j] = SV_WorldTreeUnionCost(child, leafNode) + inheritance;
+			if (child.height > 0)
+			{
+				childCost[j] -= SV_WorldTreeBoxCost(child.mins, child.maxs);
+			}
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+		{
+			break;
+		}
+		i = node.children[childCost[0] < childCost[1] ? 0 : 1];
+	}
+
+	// give it and the sibling a new parent
+	const int sibling = i;
+	const int oldParent = tree.nodes[sibling].parent;
+	const int newParent = SV_WorldTreeAllocNode(tree);
+
+	tree.nodes[newParent].parent = oldParent;
+	tree.nodes[newParent].children[0] = sibling;
+	tree.nodes[newParent].children[1] = leaf;
+	tree.nodes[sibling].parent = newParent;
+	tree.nodes[leaf].parent = newParent;
+	SV_WorldTreeReplaceChild(tree, oldParent, sibling, newParent);
+
+	SV_WorldTreeFixUpwards(tree, newParent);
+}
+
+static void SV_WorldTreeRemoveLeaf(worldTree_t& tree, const int leaf)
+{
+	tree.numLeafs--;
+
+	if (leaf == tree.root)
+	{
+		tree.root = 0;
+		return;
+	}
+
+	// the sibling takes the parent's place
+	const int parent = tree.nodes[leaf].parent;
+	const int grandParent = tree.nodes[parent].parent;
+	const int sibling = tree.nodes[parent].children[tree.nodes[parent].children[0] == leaf ? 1 : 0];
+
+	SV_WorldTreeReplaceChild(tree, grandParent, parent, sibling);
+	tree.nodes[sibling].parent = grandParent;
+	SV_WorldTreeFreeNode(tree, parent);
+
+	SV_WorldTreeFixUpwards(tree, grandParent);
+}
+
+/*
+===============
+SV_WorldTreeLink
+
+(Re)links owner with the given box, leaving it where it is if it's still inside
+its fattened box. *leaf is its leaf, 0 if it isn't in the tree yet.
+===============
+*/
+static void SV_WorldTreeLink(worldTree_t& tree, int* leaf, const int owner, const vec3_t absmin, const vec3_t absmax)
+{
+	if (*leaf)
+	{
+		const worldTreeNode_t& node = tree.nodes[*leaf];
+		if (absmin[0] >= node.mins[0] && absmin[1] >= node.mins[1] && absmin[2] >= node.mins[2]
+			&& absmax[0] <= node.maxs[0] && absmax[1] <= node.maxs[1] && absmax[2] <= node.maxs[2])
+		{
+			return;
+		}
+		SV_WorldTreeRemoveLeaf(tree, *leaf);
+	}
+	else
+	{
+		*leaf = SV_WorldTreeAllocNode(tree);
+		tree.nodes[*leaf].owner = owner;
+	}
+
+	worldTreeNode_t& node = tree.nodes[*leaf];
+	for (int i = 0; i < 3; i++)
+	{
+		node.mins[i] = absmin[i] - WORLD_TREE_MARGIN;
+		node.maxs[i] = absmax[i] + WORLD_TREE_MARGIN;
+	}
+	SV_WorldTreeInsertLeaf(tree, *leaf);
+}
+
+static void SV_WorldTreeUnlink(worldTree_t& tree, int* leaf)
+{
+	if (*leaf)
+	{
+		SV_WorldTreeRemoveLeaf(tree, *leaf);
+		SV_WorldTreeFreeNode(tree, *leaf);
+		*leaf = 0;
+	}
+}
+
+/*
+===============
+SV_WorldTreeQuery
+
+Calls visit(owner) for every leaf whose fattened box touches the given bounds, so
+visit still has to check the real box. Stops early if visit returns false.
+===============
+*/
+template <typename T>
+static void SV_WorldTreeQuery(const worldTree_t& tree, const float* mins, const float* maxs, T&& visit)
+{
+	int stack[WORLD_TREE_STACK];
+	int depth = 0;
+
+	if (tree.root)
+	{
+		stack[depth++] = tree.root;
+	}
+
+	while (depth)
+	{
+		const worldTreeNode_t& node = tree.nodes[stack[--depth]];
+		if (SV_BoxesDisjoint(node.mins, node.maxs, mins, maxs))
+		{
+			continue;
+		}
+
+		if (node.height == 0)
+		{
+			if (!visit(node.owner))
+			{
+				return;
+			}
+		}
+		else
+		{
+			// balanced, so even MAX_GENTITIES leafs are nowhere near this deep
+			assert(depth + 2 <= WORLD_TREE_STACK);
+			stack[depth++] = node.children[0];
+			stack[depth++] = node.children[1];
+		}
+	}
+}
+
+/*
+===============================================================================
+
+TRACE CACHE
+
+AI asks the same line of sight questions every frame, between spots that never
+move. A trace whose contentmask leaves out everything that walks around (bodies,
+corpses, items and triggers) and that doesn't want ghoul2 collision can only be
+stopped by the world and by brush models and other solid props, so its result
+holds until one of those is linked somewhere new, unlinked, or changes contents
+in place (func_wall and func_usable switch on and off without relinking). Each
+entry keeps the box its move sweeps through, and only the entries whose box
+overlaps where such an entity was or now is get dropped. A new map bumps the
+generation, which drops the whole cache at once.
+
+In place changes are caught by SV_SetBrushModel and SV_AdjustAreaPortalState,
+which the walls go through, and by a check of every entity's contents before
+each game frame for whatever else writes them directly.
+
+The key is the exact trace, passEntityNum included as it decides what gets
+skipped; the hash only uses the coordinates truncated to whole units.
+
+===============================================================================
+*/
+
+constexpr int TRACE_CACHE_SIZE = 2048; // power of two
+constexpr int TRACE_CACHE_UNCACHED = CONTENTS_BODY | CONTENTS_CORPSE | CONTENTS_ITEM | CONTENTS_TRIGGER;
+
+using traceCacheEntry_t = struct
+{
+	unsigned int generation; // 0 = empty
+	int passEntityNum;
+	int contentmask;
+	vec3_t start, end;
+	vec3_t mins, maxs;
+	vec3_t absmin, absmax; // encloses the whole move, as the entity clipping would see it
+
+	// the trace_t, less the ghoul2 collisions
+	qboolean allsolid;
+	qboolean startsolid;
+	float fraction;
+	vec3_t endpos;
+	cplane_t plane;
+	int surfaceFlags;
+	int contents;
+	int entityNum;
+};
+
+static traceCacheEntry_t sv_traceCacheEntries[TRACE_CACHE_SIZE];
+static unsigned int sv_traceCacheGeneration = 1;
+int sv_traceCacheHits, sv_traceCacheMisses; // for com_speeds
+
+static void SV_TraceCacheInvalidate()
+{
+	if (!++sv_traceCacheGeneration)
+	{
+		// wrapped, so the oldest entries could look current again
+		memset(sv_traceCacheEntries, 0, sizeof(sv_traceCacheEntries));
+		sv_traceCacheGeneration = 1;
+	}
+}
+
+// drops the entries whose move could touch the box
+static void SV_TraceCacheInvalidateBox(const vec3_t absmin, const vec3_t absmax)
+{
+	for (traceCacheEntry_t& entry : sv_traceCacheEntries)
+	{
+		if (entry.generation == sv_traceCacheGeneration
+			&& !SV_BoxesDisjoint(entry.absmin, entry.absmax, absmin, absmax))
+		{
+			entry.generation = 0;
+		}
+	}
+}
+
+static qboolean SV_TraceCacheable(const int contentmask, const EG2_Collision eG2TraceType)
+{
+	return sv_traceCache->integer && !(contentmask & TRACE_CACHE_UNCACHED) && eG2TraceType == G2_NOCOLLIDE
+		? qtrue
+		: qfalse;
+}
+
+static traceCacheEntry_t* SV_TraceCacheSlot(const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int passEntityNum, const int contentmask)
+{
+	const vec_t* const vecs[4] = { start, end, mins, maxs };
+	unsigned int hash = 2166136261u; // FNV-1a
+
+	for (const vec_t* v : vecs)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			// anything off the map (or NaN) would make the conversion undefined
+			const int snapped = v[i] > -MAX_WORLD_COORD && v[i] < MAX_WORLD_COORD ? static_cast<int>(v[i]) : 0;
+			hash = (hash ^ static_cast<unsigned int>(snapped)) * 16777619u;
+		}
+	}
+	hash = (hash ^ static_cast<unsigned int>(passEntityNum)) * 16777619u;
+	hash = (hash ^ static_cast<unsigned int>(contentmask)) * 16777619u;
+
+	return &sv_traceCacheEntries[(hash ^ hash >> 16) & (TRACE_CACHE_SIZE - 1)];
+}
+
+static qboolean SV_TraceCacheLookup(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int passEntityNum, const int contentmask)
+{
+	const traceCacheEntry_t* entry = SV_TraceCacheSlot(start, mins, maxs, end, passEntityNum, contentmask);
+
+	if (entry->generation != sv_traceCacheGeneration || entry->passEntityNum != passEntityNum
+		|| entry->contentmask != contentmask || !VectorCompare(entry->start, start) || !VectorCompare(entry->end, end)
+		|| !VectorCompare(entry->mins, mins) || !VectorCompare(entry->maxs, maxs))
+	{
+		sv_traceCacheMisses++;
+		return qfalse;
+	}
+
+	results->allsolid = entry->allsolid;
+	results->startsolid = entry->startsolid;
+	results->fraction = entry->fraction;
+	VectorCopy(entry->endpos, results->endpos);
+	results->plane = entry->plane;
+	results->surfaceFlags = entry->surfaceFlags;
+	results->contents = entry->contents;
+	results->entityNum = entry->entityNum;
+
+	sv_traceCacheHits++;
+	return qtrue;
+}
+
+static void SV_TraceCacheStore(const trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int passEntityNum, const int contentmask)
+{
+	traceCacheEntry_t* entry = SV_TraceCacheSlot(start, mins, maxs, end, passEntityNum, contentmask);
+
+	entry->generation = sv_traceCacheGeneration;
+	entry->passEntityNum = passEntityNum;
+	entry->contentmask = contentmask;
+	VectorCopy(start, entry->start);
+	VectorCopy(end, entry->end);
+	VectorCopy(mins, entry->mins);
+	VectorCopy(maxs, entry->maxs);
+	for (int i = 0; i < 3; i++)
+	{
+		entry->absmin[i] = (start[i] < end[i] ? start[i] : end[i]) + mins[i] - 1;
+		entry->absmax[i] = (start[i] > end[i] ? start[i] : end[i]) + maxs[i] + 1;
+	}
+
+	entry->allsolid = results->allsolid;
+	entry->startsolid = results->startsolid;
+	entry->fraction = results->fraction;
+	VectorCopy(results->endpos, entry->endpos);
+	entry->plane = results->plane;
+	entry->surfaceFlags = results->surfaceFlags;
+	entry->contents = results->contents;
+	entry->entityNum = results->entityNum;
+}
+
+// called once an entity is linked, drops the cached traces that went near it if it's something they could
+// have hit and it moved
+static void SV_TraceCacheLink(svEntity_t* ent, const gentity_t* g_ent)
+{
+	svTraceCacheState_t& state = ent->traceCacheState;
+	const int contents = g_ent->contents & ~TRACE_CACHE_UNCACHED;
+
+	if (!contents && !state.contents)
+	{
+		return;
+	}
+	if (contents == state.contents && VectorCompare(g_ent->absmin, state.absmin)
+		&& VectorCompare(g_ent->absmax, state.absmax) && VectorCompare(g_ent->currentAngles, state.angles))
+	{
+		return; // relinked where it already was
+	}
+
+	if (state.contents)
+	{
+		SV_TraceCacheInvalidateBox(state.absmin, state.absmax);
+	}
+	state.contents = contents;
+	VectorCopy(g_ent->absmin, state.absmin);
+	VectorCopy(g_ent->absmax, state.absmax);
+	VectorCopy(g_ent->currentAngles, state.angles);
+	if (contents)
+	{
+		SV_TraceCacheInvalidateBox(state.absmin, state.absmax);
+	}
+}
+
+static void SV_TraceCacheUnlink(svEntity_t* ent)
+{
+	if (ent->traceCacheState.contents)
+	{
+		ent->traceCacheState.contents = 0;
+		SV_TraceCacheInvalidateBox(ent->traceCacheState.absmin, ent->traceCacheState.absmax);
+	}
+}
+
+/*
+==================
+SV_TraceCacheEntityChanged
+
+For an entity whose contents are changing without a relink
+==================
+*/
+void SV_TraceCacheEntityChanged(const gentity_t* g_ent)
+{
+	if (!g_ent->linked)
+	{
+		return;
+	}
+
+	svEntity_t* ent = SV_SvEntityForGentity(g_ent);
+	if (ent->traceCacheState.contents)
+	{
+		SV_TraceCacheInvalidateBox(ent->traceCacheState.absmin, ent->traceCacheState.absmax);
+	}
+	SV_TraceCacheLink(ent, g_ent);
+}
+
+/*
+==================
+SV_TraceCacheCheckContents
+
+Catches the contents the game changed on linked entities without telling us
+==================
+*/
+void SV_TraceCacheCheckContents()
+{
+	for (int i = 0; i < ge->num_entities; i++)
+	{
+		const gentity_t* g_ent = SV_GentityNum(i);
+		if (g_ent->linked
+			&& (g_ent->contents & ~TRACE_CACHE_UNCACHED) != sv.svEntities[i].traceCacheState.contents)
+		{
+			SV_TraceCacheLink(&sv.svEntities[i], g_ent);
+		}
+	}
+}
+
+/*
+===============================================================================
+
+POINT LEAFS
+
+gi.inPVS and the snapshots ask which leaf a point is in over and over, mostly for
+entity origins that haven't moved since the last time. The answer only depends
+on the bsp, so a small memo of recent points lasts until the next map.
+
+===============================================================================
+*/
+
+constexpr int POINT_LEAF_CACHE_SIZE = 1024; // power of two
+
+using pointLeafEntry_t = struct
+{
+	unsigned int generation; // 0 = empty
+	vec3_t point;
+	int leafnum;
+};
+
+static pointLeafEntry_t sv_pointLeafEntries[POINT_LEAF_CACHE_SIZE];
+static unsigned int sv_pointLeafGeneration = 1;
+
+/*
+==================
+SV_PointLeafnum
 
-	VectorSubtract(maxs, mins, size);
-	if (size[0] > size[1])
+CM_PointLeafnum, remembered
+==================
+*/
+int SV_PointLeafnum(const vec3_t p)
+{
+	unsigned int hash = 2166136261u; // FNV-1a
+	for (int i = 0; i < 3; i++)
 	{
-		anode->axis = 0;
+		const int snapped = p[i] > -MAX_WORLD_COORD && p[i] < MAX_WORLD_COORD ? static_cast<int>(p[i]) : 0;
+		hash = (hash ^ static_cast<unsigned int>(snapped)) * 16777619u;
 	}
-	else
+
+	pointLeafEntry_t& entry = sv_pointLeafEntries[(hash ^ hash >> 16) & (POINT_LEAF_CACHE_SIZE - 1)];
+	if (entry.generation != sv_pointLeafGeneration || !VectorCompare(entry.point, p))
 	{
-		anode->axis = 1;
+		entry.generation = sv_pointLeafGeneration;
+		VectorCopy(p, entry.point);
+		entry.leafnum = CM_PointLeafnum(p);
 	}
-
-	anode->dist = 0.5 * (maxs[anode->axis] + mins[anode->axis]);
-	VectorCopy(mins, mins1);
-	VectorCopy(mins, mins2);
-	VectorCopy(maxs, maxs1);
-	VectorCopy(maxs, maxs2);
-
-	maxs1[anode->axis] = mins2[anode->axis] = anode->dist;
-
-	anode->children[0] = SV_CreateworldSector(depth + 1, mins2, maxs2);
-	anode->children[1] = SV_CreateworldSector(depth + 1, mins1, maxs1);
-
-	return anode;
+	return entry.leafnum;
 }
 
 /*
@@ -158,6 +807,18 @@ void SV_ClearWorld()
 	memset(sv_worldSectors, 0, sizeof(sv_worldSectors));
 	sv_numworldSectors = 0;
 
+	sv_worldTreeActive = sv_worldIndex->integer == 1 ? qtrue : qfalse;
+	SV_WorldTreeClear(sv_worldTree);
+
+	SV_TraceCacheInvalidate();
+	sv_traceCacheHits = sv_traceCacheMisses = 0;
+
+	if (!++sv_pointLeafGeneration)
+	{
+		memset(sv_pointLeafEntries, 0, sizeof(sv_pointLeafEntries));
+		sv_pointLeafGeneration = 1;
+	}
+
 	// get world map bounds
 	const clipHandle_t h = CM_InlineModel(0);
 	CM_ModelBounds(h, mins, maxs);
@@ -170,18 +831,16 @@ SV_UnlinkEntity
 
 ===============
 */
-void SV_UnlinkEntity(gentity_t* g_ent)
+static void SV_UnlinkFromWorld(gentity_t* g_ent, svEntity_t* ent)
 {
-	// this should never be called with a freed entity
-	if (!g_ent->inuse)
+	g_ent->linked = qfalse;
+
+	if (ent->worldTreeNode)
 	{
+		SV_WorldTreeUnlink(sv_worldTree, &ent->worldTreeNode);
 		return;
 	}
 
-	svEntity_t* ent = SV_SvEntityForGentity(g_ent);
-
-	g_ent->linked = qfalse;
-
 	worldSector_t* ws = ent->worldSector;
 	if (!ws)
 	{
@@ -207,6 +866,20 @@ void SV_UnlinkEntity(gentity_t* g_ent)
 	Com_Printf("WARNING: SV_UnlinkEntity: not found in worldSector\n");
 }
 
+void SV_UnlinkEntity(gentity_t* g_ent)
+{
+	// this should never be called with a freed entity
+	if (!g_ent->inuse)
+	{
+		return;
+	}
+
+	svEntity_t* ent = SV_SvEntityForGentity(g_ent);
+
+	SV_TraceCacheUnlink(ent);
+	SV_UnlinkFromWorld(g_ent, ent);
+}
+
 /*
 ===============
 SV_LinkEntity
@@ -231,7 +904,7 @@ void SV_LinkEntity(gentity_t* g_ent)
 
 	if (ent->worldSector)
 	{
-		SV_UnlinkEntity(g_ent); // unlink from old position
+		SV_UnlinkFromWorld(g_ent, ent); // unlink from old position
 	}
 
 	// encode the size into the entityState_t for client prediction
@@ -302,6 +975,7 @@ void SV_LinkEntity(gentity_t* g_ent)
 
 	// link to PVS leafs
 	ent->numClusters = 0;
+	ent->numPvsBytes = 0;
 	ent->lastCluster = 0;
 	ent->areanum = -1;
 	ent->areanum2 = -1;
@@ -314,6 +988,11 @@ void SV_LinkEntity(gentity_t* g_ent)
 	// entity is outside the world and can be considered unlinked
 	if (!num_leafs)
 	{
+		if (ent->worldTreeNode)
+		{
+			SV_UnlinkFromWorld(g_ent, ent); // the tree keeps it linked up to here, rather than unlinking up front
+		}
+		SV_TraceCacheUnlink(ent);
 		return;
 	}
 
@@ -363,6 +1042,34 @@ void SV_LinkEntity(gentity_t* g_ent)
 		ent->lastCluster = CM_LeafCluster(lastLeaf);
 	}
 
+	// and pack the clusters by PVS byte, so the snapshots test a byte of them at a time
+	for (i = 0; i < ent->numClusters; i++)
+	{
+		const int offset = ent->clusternums[i] >> 3;
+		int j;
+
+		for (j = 0; j < ent->numPvsBytes && ent->pvsBytes[j].offset != offset; j++)
+		{
+		}
+		if (j == ent->numPvsBytes)
+		{
+			ent->pvsBytes[j].offset = offset;
+			ent->pvsBytes[j].bits = 0;
+			ent->numPvsBytes++;
+		}
+		ent->pvsBytes[j].bits |= 1 << (ent->clusternums[i] & 7);
+	}
+
+	SV_TraceCacheLink(ent, g_ent);
+
+	if (sv_worldTreeActive)
+	{
+		SV_WorldTreeLink(sv_worldTree, &ent->worldTreeNode, static_cast<int>(ent - sv.svEntities), g_ent->absmin,
+			g_ent->absmax);
+		g_ent->linked = qtrue;
+		return;
+	}
+
 	// find the first world sector node that the ent's box crosses
 	worldSector_t* node = sv_worldSectors;
 	while (true)
@@ -470,7 +1177,31 @@ int SV_AreaEntities(const vec3_t mins, const vec3_t maxs, gentity_t** elist, con
 	ap.count = 0;
 	ap.maxcount = maxcount;
 
-	SV_AreaEntities_r(sv_worldSectors, &ap);
+	if (sv_worldTreeActive)
+	{
+		SV_WorldTreeQuery(sv_worldTree, mins, maxs, [&ap](const int owner)
+		{
+			gentity_t* gcheck = SV_GentityNum(owner);
+			if (SV_BoxesDisjoint(gcheck->absmin, gcheck->absmax, ap.mins, ap.maxs))
+			{
+				return true;
+			}
+
+			if (ap.count == ap.maxcount)
+			{
+				Com_DPrintf("SV_AreaEntities: reached maxcount (%d)\n", ap.maxcount);
+				return false;
+			}
+
+			ap.list[ap.count] = gcheck;
+			ap.count++;
+			return true;
+		});
+	}
+	else
+	{
+		SV_AreaEntities_r(sv_worldSectors, &ap);
+	}
 
 	return ap.count;
 }
@@ -484,6 +1215,14 @@ SV_SectorList_f
 
 void SV_SectorList_f()
 {
+	if (sv_worldTreeActive)
+	{
+		const int height = sv_worldTree.root ? sv_worldTree.nodes[sv_worldTree.root].height : 0;
+		Com_Printf("aabb tree: %d entities, %d nodes, height %d\n", sv_worldTree.numLeafs,
+			static_cast<int>(sv_worldTree.nodes.size()) - 1, height);
+		return;
+	}
+
 	for (int i = 0; i < AREA_NODES; i++)
 	{
 		const worldSector_t* sec = &sv_worldSectors[i];
@@ -613,17 +1352,17 @@ using moveclip_t = struct
 
 /*
 ====================
-SV_ClipMoveToEntities
+SV_ClipMoveToTouchList
 
+Clips against the given entities. With a list gathered for a bigger box than the
+clip's own (a trace batch shares one list), filter skips the ones outside it.
 ====================
 */
-void SV_ClipMoveToEntities(moveclip_t* clip)
+static void SV_ClipMoveToTouchList(moveclip_t* clip, gentity_t** touchlist, const int num, const qboolean filter)
 {
-	gentity_t* touchlist[MAX_GENTITIES], * owner;
+	gentity_t* owner;
 	trace_t trace, oldTrace;
 
-	const int num = SV_AreaEntities(clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
-
 	if (clip->passEntityNum != ENTITYNUM_NONE)
 	{
 		owner = (SV_GentityNum(clip->passEntityNum))->owner;
@@ -641,6 +1380,11 @@ void SV_ClipMoveToEntities(moveclip_t* clip)
 		}
 		gentity_t* touch = touchlist[i];
 
+		if (filter && SV_BoxesDisjoint(touch->absmin, touch->absmax, clip->boxmins, clip->boxmaxs))
+		{
+			continue;
+		}
+
 		// see if we should ignore this entity
 		if (clip->passEntityNum != ENTITYNUM_NONE)
 		{
@@ -859,6 +1603,96 @@ void SV_ClipMoveToEntities(moveclip_t* clip)
 	}
 }
 
+/*
+====================
+SV_ClipMoveToEntities
+
+====================
+*/
+void SV_ClipMoveToEntities(moveclip_t* clip)
+{
+	gentity_t* touchlist[MAX_GENTITIES];
+
+	const int num = SV_AreaEntities(clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
+
+	SV_ClipMoveToTouchList(clip, touchlist, num, qfalse);
+}
+
+/*
+==================
+SV_SetupMoveClip
+
+Fills in the rest of a clip whose trace already holds the world trace (which didn't
+stop dead), for clipping against entities on the part of the move that's left.
+Returns the world trace's fraction, to scale the entity one by.
+==================
+*/
+static float SV_SetupMoveClip(moveclip_t* clip, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int passEntityNum, const int contentmask, const EG2_Collision eG2TraceType,
+	const int useLod)
+{
+	clip->contentmask = contentmask;
+	/*
+	Ghoul2 Insert Start
+	*/
+	VectorCopy(start, clip->start);
+	clip->eG2TraceType = eG2TraceType;
+	clip->useLod = useLod;
+	/*
+	Ghoul2 Insert End
+	*/
+	//Shorten the trace to the size of the trace until it hit the world
+	VectorCopy(clip->trace.endpos, clip->end);
+	//remember the current completion fraction
+	const float world_frac = clip->trace.fraction;
+	//set the fraction back to 1.0 for the trace vs. entities
+	clip->trace.fraction = 1.0f;
+
+	//VectorCopy( end, clip->end );
+	// create the bounding box of the entire move
+	// we can limit it to the part of the move not
+	// already clipped off by the world, which can be
+	// a significant savings for line of sight and shot traces
+	clip->passEntityNum = passEntityNum;
+
+#if 0 //G2_SUPERSIZEDBBOX is not being used
+	vec3_t superMin;
+	vec3_t superMax;  // prison, in boscobel
+
+	if (eG2TraceType == G2_SUPERSIZEDBBOX)
+	{
+		for (i = 0; i < 3; i++)
+		{
+			superMin[i] = mins[i] - superSizedAdd;
+			superMax[i] = maxs[i] + superSizedAdd;
+		}
+		clip->mins = superMin;
+		clip->maxs = superMax;
+	}
+	else
+#endif
+	{
+		clip->mins = mins;
+		clip->maxs = maxs;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (end[i] > start[i])
+		{
+			clip->boxmins[i] = clip->start[i] + clip->mins[i] - 1;
+			clip->boxmaxs[i] = clip->end[i] + clip->maxs[i] + 1;
+		}
+		else
+		{
+			clip->boxmins[i] = clip->end[i] + clip->mins[i] - 1;
+			clip->boxmaxs[i] = clip->start[i] + clip->maxs[i] + 1;
+		}
+	}
+
+	return world_frac;
+}
+
 /*
 ==================
 SV_Trace
@@ -897,6 +1731,12 @@ void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec
 		maxs = vec3_origin;
 	}
 
+	const qboolean cacheable = SV_TraceCacheable(contentmask, eG2TraceType);
+	if (cacheable && SV_TraceCacheLookup(results, start, mins, maxs, end, passEntityNum, contentmask))
+	{
+		return;
+	}
+
 	memset(&clip, 0, sizeof(moveclip_t) - sizeof(clip.trace.G2CollisionMap));
 
 	// clip to world
@@ -910,82 +1750,184 @@ void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec
 	{
 		// blocked immediately by the world
 		*results = clip.trace;
+		if (cacheable)
+		{
+			SV_TraceCacheStore(results, start, mins, maxs, end, passEntityNum, contentmask);
+		}
 		//		goto addtime;
 		return;
 	}
 
-	clip.contentmask = contentmask;
-	/*
-	Ghoul2 Insert Start
-	*/
-	VectorCopy(start, clip.start);
-	clip.eG2TraceType = eG2TraceType;
-	clip.useLod = useLod;
+	const float world_frac = SV_SetupMoveClip(&clip, start, mins, maxs, end, passEntityNum, contentmask, eG2TraceType,
+		useLod);
+
+	// clip to other solid entities
+	SV_ClipMoveToEntities(&clip);
+
+	//scale the trace back down by the previous fraction
+	clip.trace.fraction *= world_frac;
+	*results = clip.trace;
+	if (cacheable)
+	{
+		SV_TraceCacheStore(results, start, mins, maxs, end, passEntityNum, contentmask);
+	}
+
 	/*
-	Ghoul2 Insert End
+	addtime:
+		endMS = Sys_Milliseconds ();
+
+		timeInTrace += endMS - startMS;
 	*/
-	//Shorten the trace to the size of the trace until it hit the world
-	VectorCopy(clip.trace.endpos, clip.end);
-	//remember the current completion fraction
-	const float world_frac = clip.trace.fraction;
-	//set the fraction back to 1.0 for the trace vs. entities
-	clip.trace.fraction = 1.0f;
+}
 
-	//VectorCopy( end, clip.end );
-	// create the bounding box of the entire move
-	// we can limit it to the part of the move not
-	// already clipped off by the world, which can be
-	// a significant savings for line of sight and shot traces
-	clip.passEntityNum = passEntityNum;
+/*
+==================
+SV_TraceBatch
 
-#if 0 //G2_SUPERSIZEDBBOX is not being used
-	vec3_t superMin;
-	vec3_t superMax;  // prison, in boscobel
+The same results as SV_Trace on each request in turn, but the world traces all go
+to CM_BoxTraceBatch together, and consecutive requests whose moves overlap share
+one SV_AreaEntities (a blade sweep, or several lines from one NPC's eyes).
+The entity clipping stays on this thread, as the temp box model and ghoul2
+collision aren't safe to share.
+==================
+*/
+static std::vector<cmTraceRequest_t> sv_traceBatchWorld;
+static std::vector<trace_t> sv_traceBatchWorldTraces;
+static std::vector<int> sv_traceBatchWorldIndex; // which request each world trace is for
+static std::vector<moveclip_t> sv_traceBatchClips;
+static std::vector<float> sv_traceBatchWorldFrac; // < 0 if already answered, from the cache or stopped dead by the world
+static gentity_t* sv_traceBatchTouch[MAX_GENTITIES];
+
+void SV_TraceBatch(trace_t* results, const traceRequest_t* requests, const int numRequests)
+{
+	int i;
 
-	if (eG2TraceType == G2_SUPERSIZEDBBOX)
+	if (numRequests <= 0)
 	{
-		for (i = 0; i < 3; i++)
+		return;
+	}
+
+	if (static_cast<int>(sv_traceBatchClips.size()) < numRequests)
+	{
+		sv_traceBatchWorld.resize(numRequests);
+		sv_traceBatchWorldTraces.resize(numRequests);
+		sv_traceBatchWorldIndex.resize(numRequests);
+		sv_traceBatchClips.resize(numRequests);
+		sv_traceBatchWorldFrac.resize(numRequests);
+	}
+
+	// clip to world, for everything the cache can't answer
+	int num_world = 0;
+	for (i = 0; i < numRequests; i++)
+	{
+		const traceRequest_t& request = requests[i];
+#ifdef _DEBUG
+		assert(
+			!Q_isnan(request.start[0]) && !Q_isnan(request.start[1]) && !Q_isnan(request.start[2]) &&
+			!Q_isnan(request.end[0]) && !Q_isnan(request.end[1]) && !Q_isnan(request.end[2]));
+#endif// _DEBUG
+
+		if (SV_TraceCacheable(request.contentmask, request.eG2TraceType)
+			&& SV_TraceCacheLookup(&results[i], request.start, request.mins, request.maxs, request.end,
+				request.passEntityNum, request.contentmask))
 		{
-			superMin[i] = mins[i] - superSizedAdd;
-			superMax[i] = maxs[i] + superSizedAdd;
+			sv_traceBatchWorldFrac[i] = -1.0f;
+			continue;
 		}
-		clip.mins = superMin;
-		clip.maxs = superMax;
+
+		cmTraceRequest_t& world = sv_traceBatchWorld[num_world];
+		sv_traceBatchWorldIndex[num_world++] = i;
+
+		VectorCopy(request.start, world.start);
+		VectorCopy(request.end, world.end);
+		VectorCopy(request.mins, world.mins);
+		VectorCopy(request.maxs, world.maxs);
+		world.model = 0;
+		world.brushmask = request.contentmask;
 	}
-	else
-#endif
+	CM_BoxTraceBatch(sv_traceBatchWorldTraces.data(), sv_traceBatchWorld.data(), num_world);
+
+	for (int j = 0; j < num_world; j++)
 	{
-		clip.mins = mins;
-		clip.maxs = maxs;
+		i = sv_traceBatchWorldIndex[j];
+		const traceRequest_t& request = requests[i];
+		moveclip_t& clip = sv_traceBatchClips[i];
+
+		memset(&clip, 0, sizeof(moveclip_t) - sizeof(clip.trace.G2CollisionMap));
+		clip.trace = sv_traceBatchWorldTraces[j];
+		clip.trace.entityNum = clip.trace.fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+		if (clip.trace.fraction == 0)
+		{
+			// blocked immediately by the world
+			results[i] = clip.trace;
+			if (SV_TraceCacheable(request.contentmask, request.eG2TraceType))
+			{
+				SV_TraceCacheStore(&results[i], request.start, request.mins, request.maxs, request.end,
+					request.passEntityNum, request.contentmask);
+			}
+			sv_traceBatchWorldFrac[i] = -1.0f;
+			continue;
+		}
+
+		sv_traceBatchWorldFrac[i] = SV_SetupMoveClip(&clip, request.start, request.mins, request.maxs, request.end,
+			request.passEntityNum, request.contentmask, request.eG2TraceType, request.useLod);
 	}
 
-	for (int i = 0; i < 3; i++)
+	// clip to other solid entities, a run of overlapping moves at a time
+	for (i = 0; i < numRequests;)
 	{
-		if (end[i] > start[i])
+		if (sv_traceBatchWorldFrac[i] < 0)
 		{
-			clip.boxmins[i] = clip.start[i] + clip.mins[i] - 1;
-			clip.boxmaxs[i] = clip.end[i] + clip.maxs[i] + 1;
+			i++;
+			continue;
 		}
-		else
+
+		vec3_t mins, maxs;
+		VectorCopy(sv_traceBatchClips[i].boxmins, mins);
+		VectorCopy(sv_traceBatchClips[i].boxmaxs, maxs);
+
+		int end = i + 1;
+		int num_clips = 1;
+		for (; end < numRequests; end++)
 		{
-			clip.boxmins[i] = clip.end[i] + clip.mins[i] - 1;
-			clip.boxmaxs[i] = clip.start[i] + clip.maxs[i] + 1;
+			if (sv_traceBatchWorldFrac[end] < 0)
+			{
+				continue;
+			}
+			const moveclip_t& clip = sv_traceBatchClips[end];
+			if (SV_BoxesDisjoint(clip.boxmins, clip.boxmaxs, mins, maxs))
+			{
+				break;
+			}
+			AddPointToBounds(clip.boxmins, mins, maxs);
+			AddPointToBounds(clip.boxmaxs, mins, maxs);
+			num_clips++;
 		}
-	}
 
-	// clip to other solid entities
-	SV_ClipMoveToEntities(&clip);
+		const int num = SV_AreaEntities(mins, maxs, sv_traceBatchTouch, MAX_GENTITIES);
 
-	//scale the trace back down by the previous fraction
-	clip.trace.fraction *= world_frac;
-	*results = clip.trace;
+		for (; i < end; i++)
+		{
+			if (sv_traceBatchWorldFrac[i] < 0)
+			{
+				continue;
+			}
+			moveclip_t& clip = sv_traceBatchClips[i];
 
-	/*
-	addtime:
-		endMS = Sys_Milliseconds ();
+			SV_ClipMoveToTouchList(&clip, sv_traceBatchTouch, num, num_clips > 1 ? qtrue : qfalse);
 
-		timeInTrace += endMS - startMS;
-	*/
+			//scale the trace back down by the previous fraction
+			clip.trace.fraction *= sv_traceBatchWorldFrac[i];
+			results[i] = clip.trace;
+
+			const traceRequest_t& request = requests[i];
+			if (SV_TraceCacheable(request.contentmask, request.eG2TraceType))
+			{
+				SV_TraceCacheStore(&results[i], request.start, request.mins, request.maxs, request.end,
+					request.passEntityNum, request.contentmask);
+			}
+		}
+	}
 }
 
 /*
@@ -163,6 +163,17 @@ time_t Sys_FileTime(const char* path);
 
 qboolean Sys_LowPhysicalMemory();
 
+// page-granular memory straight from the OS, for the zone's guard-page mode...
+int Sys_PageSize();
+void* Sys_PageAlloc(size_t size); // committed read/write, NULL on failure
+void Sys_PageFree(void* pages, size_t size);
+void Sys_PageNoAccess(void* pages, size_t size); // any touch of these faults from now on
+
+// whole-file mapping for zero-copy pk3 reads. Private copy-on-write, so writes through it
+//	never reach the file...
+void* Sys_MapFile(const char* path, size_t* size); // NULL on failure
+void Sys_UnmapFile(void* base, size_t size);
+
 void Sys_SetProcessorAffinity();
 
 using graphicsApi_t = enum graphicsApi_e
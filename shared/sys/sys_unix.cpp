@@ -27,6 +27,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <libgen.h>
@@ -159,6 +160,94 @@ qboolean Sys_LowPhysicalMemory( void )
 	return qfalse;
 }
 
+/*
+==================
+Sys_PageSize
+==================
+*/
+int Sys_PageSize( void )
+{
+	static int pageSize = 0;
+
+	if ( !pageSize )
+		pageSize = (int)sysconf( _SC_PAGESIZE );
+
+	return pageSize;
+}
+
+/*
+==================
+Sys_PageAlloc
+==================
+*/
+void *Sys_PageAlloc( size_t size )
+{
+	void *pages = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+	return ( pages == MAP_FAILED ) ? NULL : pages;
+}
+
+/*
+==================
+Sys_PageFree
+==================
+*/
+void Sys_PageFree( void *pages, size_t size )
+{
+	munmap( pages, size );
+}
+
+/*
+==================
+Sys_PageNoAccess
+==================
+*/
+void Sys_PageNoAccess( void *pages, size_t size )
+{
+	mprotect( pages, size, PROT_NONE );
+}
+
+/*
+==================
+Sys_MapFile
+==================
+*/
+void *Sys_MapFile( const char *path, size_t *size )
+{
+	struct stat st;
+	void *base;
+	int fd;
+
+	fd = open( path, O_RDONLY );
+	if ( fd == -1 )
+		return NULL;
+
+	if ( fstat( fd, &st ) == -1 || st.st_size <= 0 )
+	{
+		close( fd );
+		return NULL;
+	}
+
+	base = mmap( NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	close( fd );	// the mapping keeps its own reference
+
+	if ( base == MAP_FAILED )
+		return NULL;
+
+	*size = (size_t)st.st_size;
+	return base;
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile( void *base, size_t size )
+{
+	munmap( base, size );
+}
+
 /*
 ==================
 Sys_Basename
@@ -252,6 +252,116 @@ qboolean Sys_LowPhysicalMemory()
 	return stat.ullTotalPhys <= MEM_THRESHOLD ? qtrue : qfalse;
 }
 
+/*
+==================
+Sys_PageSize
+==================
+*/
+int Sys_PageSize()
+{
+	static int pageSize = 0;
+
+	if (!pageSize)
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		pageSize = info.dwPageSize;
+	}
+	return pageSize;
+}
+
+#ifndef NDEBUG
+// whether [base, base + size) lies inside the one allocation or view that starts at base
+static bool Sys_RegionIsWhole(void* base, const size_t size)
+{
+	MEMORY_BASIC_INFORMATION info;
+	return VirtualQuery(static_cast<char*>(base) + size - 1, &info, sizeof info) == sizeof info
+		&& info.AllocationBase == base;
+}
+#endif
+
+/*
+==================
+Sys_PageAlloc
+==================
+*/
+void* Sys_PageAlloc(const size_t size)
+{
+	return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+/*
+==================
+Sys_PageFree
+==================
+*/
+void Sys_PageFree(void* pages, size_t size)
+{
+	// MEM_RELEASE frees the whole allocation, so size has to be all of it
+	assert(Sys_RegionIsWhole(pages, size));
+	VirtualFree(pages, 0, MEM_RELEASE);
+}
+
+/*
+==================
+Sys_PageNoAccess
+==================
+*/
+void Sys_PageNoAccess(void* pages, const size_t size)
+{
+	DWORD oldProtect;
+	VirtualProtect(pages, size, PAGE_NOACCESS, &oldProtect);
+}
+
+/*
+==================
+Sys_MapFile
+==================
+*/
+void* Sys_MapFile(const char* path, size_t* size)
+{
+	const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return nullptr;
+	}
+
+	void* base = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping); // the view keeps its own reference
+	if (!base)
+	{
+		return nullptr;
+	}
+
+	*size = static_cast<size_t>(fileSize.QuadPart);
+	return base;
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile(void* base, size_t size)
+{
+	assert(Sys_RegionIsWhole(base, size));
+	UnmapViewOfFile(base);
+}
+
 /*
 ==============
 Sys_Mkdir